@@ -7,6 +7,9 @@
 struct CustomModel : public Voyager::BaseModel {
     String description;
     int statusCode;
+
+    explicit CustomModel(String version, String description, String downloadURL, int statusCode)
+        : BaseModel(version, downloadURL), description(description), statusCode(statusCode) {}
 };
 
 class CustomParser : public Voyager::IParser<Voyager::HTTPResponseData, CustomModel> {
@@ -36,7 +39,7 @@ public:
 void setup() {
     Serial.begin(9600);
     auto parser = std::make_unique<CustomParser>();
-    Voyager::OTA<Voyager::HTTPResponseData, CustomModel> ota(std::move(parser), CURRENT_FIRMWARE_VERSION);
+    Voyager::OTA<Voyager::HTTPResponseData, CustomModel> ota(CURRENT_FIRMWARE_VERSION, std::move(parser));
 
     ota.setReleaseURL("https://your-custom-backend/firmware/latest");
     auto release = ota.fetchLatestRelease();
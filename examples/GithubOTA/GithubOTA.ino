@@ -20,7 +20,7 @@ void setup() {
     connectToWifi();
 
     std::unique_ptr<GithubJSONParser> parser = std::make_unique<GithubJSONParser>();
-    OTA<HTTPResponseData, GithubReleaseModel> ota(std::move(parser), CURRENT_FIRMWARE_VERSION);
+    OTA<HTTPResponseData, GithubReleaseModel> ota(CURRENT_FIRMWARE_VERSION, std::move(parser));
 
     // https://docs.github.com/en/rest/releases/releases?apiVersion=2022-11-28#:~:text=GET-,/repos/%7Bowner%7D/%7Brepo%7D/releases,-cURL
     std::vector<Header> releaseHeaders = {
@@ -46,7 +46,7 @@ void setup() {
             {"Accept", "application/octet-stream"},
         };
 
-        ota.setDownloadURL(release->browserDownloadUrl, downloadHeaders);
+        ota.setDownloadURL(release->downloadURL, downloadHeaders);
         ota.performUpdate();
     } else {
         Serial.println("No updates available yet!");
@@ -0,0 +1,195 @@
+// The hand-written download loop against what httpUpdate.update() did: MD5
+// check, 304 handling and per-sector progress, plus the rate limiter.
+#define __ENABLE_DEVELOPMENT_MODE__ true
+
+#include <VoyagerOTA.hpp>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <vector>
+#include "MockVoyager.h"
+
+class DownloadTest : public ::testing::TestWithParam<bool> {
+protected:
+    void SetUp() override {
+        Shim::reset();
+        Shim::esp().throwOnRestart = false;
+
+        ota.setBaseURL(MockVoyager::BASE_URL);
+        ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+        ota.setFlashPreErase(GetParam());
+        ota.attachEventCallbacks([] {},
+                                 [this](int current, int total) { progress.push_back(current); },
+                                 [] {},
+                                 [this](int code) { errorCode = code; });
+    }
+
+    void TearDown() override { Shim::reset(); }
+
+    void performUpdate() {
+        MockVoyager::serve(release);
+        ota.setDownloadURL(release.downloadURL());
+        ota.performUpdate();
+    }
+
+    MockVoyager::Release release;
+    Voyager::OTA<> ota{"1.0.0"};
+    std::vector<int> progress;
+    int errorCode = 0;
+};
+
+INSTANTIATE_TEST_SUITE_P(Writers, DownloadTest, ::testing::Values(false, true), [](const ::testing::TestParamInfo<bool>& info) {
+    return info.param ? std::string("PartitionWriter") : std::string("Update");
+});
+
+TEST_P(DownloadTest, MatchingMD5Installs) {
+    release.md5 = Shim::md5Hex(release.image);
+    // case of the header does not matter....
+    for (char& digit : release.md5) {
+        digit = static_cast<char>(toupper(digit));
+    }
+    performUpdate();
+
+    EXPECT_EQ(errorCode, 0);
+    EXPECT_EQ(ota.getLastUpdateResult(), HTTP_UPDATE_OK);
+    EXPECT_EQ(Shim::Boot::bootSlot(), 1);
+}
+
+TEST_P(DownloadTest, MD5MismatchKeepsRunningImage) {
+    release.md5 = Shim::md5Hex(Shim::makeFirmwareImage(release.image.size(), 8));
+    performUpdate();
+
+    EXPECT_EQ(errorCode, GetParam() ? Voyager::PartitionError::MD5_MISMATCH : UPDATE_ERROR_MD5);
+    EXPECT_EQ(ota.getLastUpdateResult(), HTTP_UPDATE_FAILED);
+    EXPECT_EQ(Shim::Boot::bootSlot(), 0);
+    EXPECT_EQ(Shim::restartCount(), 0);
+}
+
+TEST_P(DownloadTest, MalformedMD5IsRejectedBeforeWriting) {
+    release.md5 = "not-an-md5";
+    performUpdate();
+
+    EXPECT_EQ(errorCode, HTTP_UE_SERVER_FAULTY_MD5);
+    EXPECT_EQ(Shim::Flash::stats().bytesWritten, 0u);
+    EXPECT_EQ(Shim::Boot::bootSlot(), 0);
+}
+
+TEST_P(DownloadTest, NotModifiedIsNoUpdate) {
+    MockVoyager::serve(release);
+    Shim::MockServer::instance().on(release.downloadPath(), [](const Shim::HttpRequest&) { return Shim::HttpResponse::withStatus(304); });
+    ota.setDownloadURL(release.downloadURL());
+    ota.performUpdate();
+
+    EXPECT_EQ(ota.getLastUpdateResult(), HTTP_UPDATE_NO_UPDATES);
+    EXPECT_EQ(errorCode, 0);
+    EXPECT_EQ(Shim::restartCount(), 0);
+    EXPECT_NE(Shim::takeSerialOutput().find("VOYAGER_OTA NO_HTTP_UPDATE_AVAILABLE"), std::string::npos);
+}
+
+TEST_P(DownloadTest, ProgressFiresOncePerSector) {
+    release.image = Shim::makeFirmwareImage(64 * Shim::Flash::SECTOR_SIZE + 100);
+    performUpdate();
+    ASSERT_EQ(errorCode, 0);
+
+    // 0, every sector, then the tail....
+    const int size = static_cast<int>(release.image.size());
+    ASSERT_EQ(progress.size(), 66u);
+    EXPECT_EQ(progress.front(), 0);
+    EXPECT_EQ(progress.back(), size);
+    for (size_t i = 1; i + 1 < progress.size(); i++) {
+        EXPECT_EQ(progress[i] / static_cast<int>(Shim::Flash::SECTOR_SIZE), static_cast<int>(i)) << "report " << i;
+        EXPECT_GT(progress[i], progress[i - 1]);
+    }
+}
+
+TEST_P(DownloadTest, SendsTheHeadersOfHttpUpdate) {
+    performUpdate();
+    ASSERT_EQ(errorCode, 0);
+
+    Shim::HttpRequest request = Shim::MockServer::instance().lastRequest();
+    ASSERT_EQ(request.path, release.downloadPath());
+    EXPECT_EQ(request.header("User-Agent"), "ESP32-http-Update");
+    EXPECT_EQ(request.header("Cache-Control"), "no-cache");
+    EXPECT_EQ(request.header("x-ESP32-STA-MAC"), "24:0A:C4:00:00:01");
+    EXPECT_EQ(request.header("x-ESP32-AP-MAC"), "24:0A:C4:00:00:02");
+    EXPECT_EQ(request.header("x-ESP32-mode"), "sketch");
+    EXPECT_EQ(request.header("x-ESP32-free-space"), std::to_string(ESP.getFreeSketchSpace()));
+    EXPECT_TRUE(request.hasHeader("x-ESP32-sketch-size"));
+    EXPECT_TRUE(request.hasHeader("x-ESP32-chip-size"));
+    EXPECT_TRUE(request.hasHeader("x-ESP32-sdk-version"));
+}
+
+TEST_P(DownloadTest, RateLimitedDownloadTakesExpectedTime) {
+    // instant flash, so only the limiter paces the transfer....
+    Shim::Flash::Config config;
+    config.eraseMicrosPerSector = 0;
+    config.writeNanosPerByte = 0;
+    Shim::Flash::configure(config);
+
+    constexpr uint32_t RATE = 32 * 1024;
+    ota.setDownloadRateLimit(RATE);
+    uint64_t startedAt = Shim::Clock::nowMicros();
+    performUpdate();
+    ASSERT_EQ(errorCode, 0);
+
+    double seconds = static_cast<double>(Shim::Clock::nowMicros() - startedAt) / 1e6;
+    double expected = static_cast<double>(release.image.size()) / RATE;
+    EXPECT_NEAR(seconds, expected, expected * 0.02);
+}
+
+TEST(RateLimiterTest, CancelStopsTheSleep) {
+    Shim::reset();
+    Voyager::RateLimiter limiter;
+    limiter.setRate(1024);
+    limiter.reset(micros());
+
+    // a minute worth of debt, given up before the first slice....
+    Voyager::CancellationToken token;
+    token.cancel();
+    uint64_t startedAt = Shim::Clock::nowMicros();
+    EXPECT_FALSE(limiter.acquire(60 * 1024, &token));
+    EXPECT_EQ(Shim::Clock::nowMicros(), startedAt);
+    Shim::reset();
+}
+
+TEST(RateLimiterTest, RatesBelowOneByteASliceStillProgress) {
+    Shim::reset();
+    Voyager::RateLimiter limiter;
+    limiter.setRate(10);
+    limiter.reset(micros());
+
+    uint64_t startedAt = Shim::Clock::nowMicros();
+    EXPECT_TRUE(limiter.acquire(100));
+    EXPECT_NEAR(static_cast<double>(Shim::Clock::nowMicros() - startedAt) / 1e6, 10.0, 0.1);
+    Shim::reset();
+}
+
+// Achieved rate of RateLimiter against the configured one, on the simulated
+// clock, for chunk sizes below and above the burst.
+TEST(RateLimiterBenchmark, AchievedRateTracksConfiguredRate) {
+    const uint32_t rates[] = {8 * 1024, 32 * 1024, 200 * 1024};
+    const size_t chunkSizes[] = {256, 1024, 4096, 16384};
+
+    printf("%12s %8s %14s %8s\n", "rate B/s", "chunk", "achieved B/s", "error");
+    for (uint32_t rate : rates) {
+        for (size_t chunkSize : chunkSizes) {
+            Shim::reset();
+            Voyager::RateLimiter limiter;
+            limiter.setRate(rate);
+            limiter.reset(micros());
+
+            // ten seconds worth of data....
+            const size_t total = static_cast<size_t>(rate) * 10;
+            uint64_t startedAt = Shim::Clock::nowMicros();
+            for (size_t sent = 0; sent < total; sent += chunkSize) {
+                ASSERT_TRUE(limiter.acquire(chunkSize));
+            }
+
+            double seconds = static_cast<double>(Shim::Clock::nowMicros() - startedAt) / 1e6;
+            double achieved = static_cast<double>(total) / seconds;
+            double error = (achieved - rate) / rate;
+            printf("%12" PRIu32 " %8zu %14.0f %7.2f%%\n", rate, chunkSize, achieved, error * 100);
+            EXPECT_NEAR(achieved, rate, rate * 0.01) << "rate " << rate << ", chunk " << chunkSize;
+        }
+    }
+    Shim::reset();
+}
@@ -0,0 +1,196 @@
+// HealthCheck across simulated reboots: the shim's partition table and
+// bootloader model decide which slot comes up, NVS keeps the boot record.
+#define __ENABLE_DEVELOPMENT_MODE__ true
+
+#include <VoyagerOTA.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include "MockVoyager.h"
+
+namespace {
+    struct ProbeCrash {};
+}  // namespace
+
+class HealthCheckTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Shim::reset();
+        setRollbackEnabled(true);
+        MockVoyager::serve(release);
+    }
+
+    void TearDown() override { Shim::reset(); }
+
+    static void setRollbackEnabled(bool isEnabled) {
+        Shim::Flash::Config config;
+        config.isRollbackEnabled = isEnabled;
+        Shim::Flash::configure(config);
+    }
+
+    // Installs the release with a health check attached, up to the reboot
+    // into the new image.
+    void installRelease() {
+        HealthCheck health;
+        ASSERT_TRUE(health.begin());
+
+        Voyager::OTA<> ota("1.0.0");
+        ota.setBaseURL(MockVoyager::BASE_URL);
+        ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+        ota.setHealthCheck(health);
+        ASSERT_TRUE(ota.fetchLatestRelease().has_value());
+        ota.setDownloadURL(release.downloadURL());
+        EXPECT_THROW(ota.performUpdate(), Shim::Restart);
+        ASSERT_EQ(Shim::Boot::runningSlot(), 1);
+    }
+
+    // setup() of the freshly booted image, with a new HealthCheck as RAM does
+    // not survive the reboot. Returns false when run() rebooted the device.
+    bool boot(Voyager::BootState& state, Voyager::HealthProbe probe, uint8_t maxBootAttempts = 3) {
+        health = std::make_unique<HealthCheck>();
+        EXPECT_TRUE(health->begin());
+        health->addProbe("probe", probe);
+        health->setMaxBootAttempts(maxBootAttempts);
+        try {
+            state = health->run(1000);
+        } catch (const Shim::Restart&) {
+            return false;
+        }
+        return true;
+    }
+
+    using HealthCheck = Voyager::HealthCheck;
+
+    MockVoyager::Release release;
+    std::unique_ptr<HealthCheck> health;
+    Voyager::BootState state = Voyager::BootState::NORMAL;
+};
+
+TEST_F(HealthCheckTest, BeginOnEmptyStorage) {
+    HealthCheck fresh("never-used");
+    EXPECT_TRUE(fresh.begin());
+    EXPECT_EQ(fresh.getRecord().state, Voyager::BootState::NORMAL);
+    EXPECT_EQ(fresh.run(1000), Voyager::BootState::NORMAL);
+}
+
+TEST_F(HealthCheckTest, PassingProbesCommit) {
+    installRelease();
+
+    ASSERT_TRUE(boot(state, [] { return true; }));
+    EXPECT_EQ(state, Voyager::BootState::COMMITTED);
+
+    // the bootloader keeps the confirmed image....
+    Shim::Boot::reset();
+    EXPECT_EQ(Shim::Boot::runningSlot(), 1);
+}
+
+TEST_F(HealthCheckTest, FailingProbeRollsBack) {
+    installRelease();
+
+    EXPECT_FALSE(boot(state, [] { return false; }));
+    EXPECT_EQ(Shim::Boot::runningSlot(), 0);
+
+    ASSERT_TRUE(boot(state, [] { return true; }));
+    EXPECT_EQ(state, Voyager::BootState::ROLLED_BACK);
+    EXPECT_TRUE(health->isFailedVersion("1.1.0"));
+}
+
+TEST_F(HealthCheckTest, BootloaderRevertIsRecordedWithoutProbing) {
+    installRelease();
+
+    // the new image crashes before setup() reaches run(), the bootloader
+    // aborts it on the next boot....
+    Shim::Boot::reset();
+    ASSERT_EQ(Shim::Boot::runningSlot(), 0);
+    int restarts = Shim::restartCount();
+
+    int probes = 0;
+    ASSERT_TRUE(boot(state, [&probes] { return ++probes > 0; }));
+    EXPECT_EQ(state, Voyager::BootState::ROLLED_BACK);
+    EXPECT_EQ(probes, 0);
+    EXPECT_EQ(Shim::restartCount(), restarts);
+    EXPECT_TRUE(health->isFailedVersion("1.1.0"));
+    EXPECT_EQ(Shim::Boot::runningSlot(), 0);
+}
+
+TEST_F(HealthCheckTest, UnbootableImageIsRecordedWithoutProbing) {
+    setRollbackEnabled(false);
+    Shim::Flash::install(1, Shim::makeFirmwareImage(64 * 1024, 3));
+    ASSERT_EQ(esp_ota_set_boot_partition(esp_ota_get_next_update_partition(nullptr)), ESP_OK);
+
+    {
+        HealthCheck pending;
+        ASSERT_TRUE(pending.begin());
+        pending.markPending("1.1.0");
+    }
+
+    // the image no longer validates, the old one comes back up....
+    Shim::Flash::contents(1)[0] = 0x00;
+    Shim::Boot::reset();
+    ASSERT_EQ(Shim::Boot::runningSlot(), 0);
+
+    int probes = 0;
+    ASSERT_TRUE(boot(state, [&probes] { return ++probes > 0; }));
+    EXPECT_EQ(state, Voyager::BootState::ROLLED_BACK);
+    EXPECT_EQ(probes, 0);
+}
+
+TEST_F(HealthCheckTest, LongFailedVersionIsRecognised) {
+    const String version = "3.0.0-beta.20261018+build.7f3c2a9";
+    setRollbackEnabled(false);
+    Shim::Flash::install(1, Shim::makeFirmwareImage(64 * 1024, 3));
+    ASSERT_EQ(esp_ota_set_boot_partition(esp_ota_get_next_update_partition(nullptr)), ESP_OK);
+
+    {
+        HealthCheck pending;
+        ASSERT_TRUE(pending.begin());
+        pending.markPending(version);
+    }
+
+    Shim::Flash::contents(1)[0] = 0x00;
+    Shim::Boot::reset();
+    ASSERT_TRUE(boot(state, [] { return true; }));
+    ASSERT_EQ(state, Voyager::BootState::ROLLED_BACK);
+
+    // stored shortened, compared the same way....
+    EXPECT_TRUE(health->isFailedVersion(version));
+    EXPECT_FALSE(health->isFailedVersion("3.0.0-beta.20261018+build.8e4d3b0"));
+}
+
+TEST_F(HealthCheckTest, CrashLoopUsesUpBootAttempts) {
+    setRollbackEnabled(false);
+    installRelease();
+
+    // a probe that crashes the device, with no bootloader rollback to catch it....
+    for (int i = 0; i < 2; i++) {
+        EXPECT_THROW(boot(state, []() -> bool { throw ProbeCrash(); }, 2), ProbeCrash);
+        Shim::Boot::reset();
+        ASSERT_EQ(Shim::Boot::runningSlot(), 1);
+    }
+
+    EXPECT_FALSE(boot(state, [] { return true; }, 2));
+    EXPECT_EQ(Shim::Boot::runningSlot(), 0);
+    EXPECT_EQ(health->getRecord().state, Voyager::BootState::ROLLED_BACK);
+}
+
+TEST_F(HealthCheckTest, RolledBackReleaseIsNotDownloadedAgain) {
+    installRelease();
+    Shim::Boot::reset();
+    ASSERT_TRUE(boot(state, [] { return true; }));
+    ASSERT_EQ(state, Voyager::BootState::ROLLED_BACK);
+
+    Voyager::OTA<> ota("1.0.0");
+    ota.setBaseURL(MockVoyager::BASE_URL);
+    ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+    ota.setHealthCheck(*health);
+    std::optional<Voyager::VoyagerReleaseModel> latest = ota.fetchLatestRelease();
+    ASSERT_TRUE(latest.has_value());
+    EXPECT_EQ(ota.getReleaseDecision(*latest), Voyager::ReleaseDecision::KNOWN_BAD);
+
+    int errorCode = 0;
+    ota.attachEventCallbacks([] {}, [](int, int) {}, [] {}, [&errorCode](int code) { errorCode = code; });
+    ota.setDownloadURL(release.downloadURL());
+    uint64_t requests = Shim::MockServer::instance().stats().requests;
+    ota.performUpdate();
+    EXPECT_EQ(errorCode, Voyager::UpdateError::ROLLED_BACK_RELEASE);
+    EXPECT_EQ(Shim::MockServer::instance().stats().requests, requests);
+}
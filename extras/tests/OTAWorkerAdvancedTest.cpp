@@ -0,0 +1,38 @@
+// OTAWorker<> in advanced mode defaults to the GitHub release model.
+#define __ENABLE_ADVANCED_MODE__ true
+
+#include <OTAWorker.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include "MockVoyager.h"
+
+TEST(OTAWorkerAdvancedTest, ChecksGithubRelease) {
+    static_assert(std::is_same_v<Voyager::OTAWorker<>::Client, Voyager::OTA<Voyager::HTTPResponseData, Voyager::GithubReleaseModel>>);
+
+    Shim::reset();
+    Shim::MockServer::instance().on("/repos/owner/repo/releases/latest", [](const Shim::HttpRequest&) {
+        return Shim::HttpResponse::json(200,
+                                        "{\"tag_name\":\"1.2.0\",\"name\":\"Spring\",\"published_at\":\"2026-10-01T10:00:00Z\","
+                                        "\"assets\":[{\"url\":\"https://api.github.test/assets/1\",\"size\":4096}]}");
+    });
+
+    Voyager::OTAWorker<> worker("1.0.0");
+    worker.client().setReleaseURL("https://api.github.test/repos/owner/repo/releases/latest");
+    ASSERT_TRUE(worker.begin());
+    worker.post(Voyager::WorkerCommand::CHECK);
+
+    Voyager::WorkerEvent event;
+    bool isReceived = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!isReceived && std::chrono::steady_clock::now() < deadline) {
+        isReceived = worker.poll(event);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    ASSERT_TRUE(isReceived);
+    EXPECT_EQ(event.type, Voyager::WorkerEventType::RELEASE_AVAILABLE);
+    EXPECT_STREQ(event.version, "1.2.0");
+    worker.end();
+    Shim::reset();
+}
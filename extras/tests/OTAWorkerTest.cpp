@@ -0,0 +1,259 @@
+// OTAWorker on the std::thread backend of the shim: command ordering,
+// cancellation racing the start of an update, and shutdown.
+#define __ENABLE_DEVELOPMENT_MODE__ true
+
+#include <OTAWorker.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "MockVoyager.h"
+
+using Voyager::WorkerCommand;
+using Voyager::WorkerEvent;
+using Voyager::WorkerEventType;
+
+namespace {
+    // Holds a mock handler until the test lets it through.
+    class Gate {
+    public:
+        void open() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _isOpen = true;
+            _changed.notify_all();
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _isOpen = false;
+            _isEntered = false;
+        }
+
+        void pass() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _isEntered = true;
+            _changed.notify_all();
+            _changed.wait_for(lock, std::chrono::seconds(5), [this] { return _isOpen; });
+        }
+
+        bool waitEntered() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            return _changed.wait_for(lock, std::chrono::seconds(5), [this] { return _isEntered; });
+        }
+
+    private:
+        std::mutex _mutex;
+        std::condition_variable _changed;
+        bool _isOpen = true;
+        bool _isEntered = false;
+    };
+
+    template <typename T_Worker>
+    bool waitFor(T_Worker& worker, WorkerEventType type, WorkerEvent* received = nullptr) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        WorkerEvent event;
+        while (std::chrono::steady_clock::now() < deadline) {
+            while (worker.poll(event)) {
+                if (event.type == type) {
+                    if (received != nullptr) {
+                        *received = event;
+                    }
+                    return true;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        return false;
+    }
+}  // namespace
+
+class OTAWorkerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Shim::reset();
+        Shim::esp().throwOnRestart = false;
+        MockVoyager::serve(release);
+
+        worker.client().setBaseURL(MockVoyager::BASE_URL);
+        worker.client().setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+    }
+
+    void TearDown() override {
+        gate.open();
+        worker.end();
+        Shim::reset();
+    }
+
+    // Routes the image download through the gate.
+    void gateDownload() {
+        Shim::MockServer::instance().on(release.downloadPath(), [this](const Shim::HttpRequest&) {
+            gate.pass();
+            return Shim::HttpResponse::binary(std::string(release.image.begin(), release.image.end()));
+        });
+    }
+
+    MockVoyager::Release release;
+    Gate gate;
+    Voyager::OTAWorker<> worker{"1.0.0"};
+};
+
+TEST_F(OTAWorkerTest, DefaultModelFollowsTheMode) {
+    static_assert(std::is_same_v<Voyager::OTAWorker<>::Client, Voyager::OTA<Voyager::HTTPResponseData, Voyager::DefaultReleaseModel>>);
+
+    ASSERT_TRUE(worker.begin());
+    ASSERT_TRUE(worker.post(WorkerCommand::CHECK));
+
+    WorkerEvent event;
+    ASSERT_TRUE(waitFor(worker, WorkerEventType::RELEASE_AVAILABLE, &event));
+    EXPECT_STREQ(event.version, "1.1.0");
+}
+
+TEST_F(OTAWorkerTest, UpdateInstallsRelease) {
+    ASSERT_TRUE(worker.begin());
+    worker.post(WorkerCommand::CHECK);
+    ASSERT_TRUE(waitFor(worker, WorkerEventType::RELEASE_AVAILABLE));
+
+    worker.post(WorkerCommand::UPDATE);
+    ASSERT_TRUE(waitFor(worker, WorkerEventType::UPDATE_FINISHED));
+    EXPECT_EQ(Shim::restartCount(), 1);
+    EXPECT_EQ(Shim::Boot::runningSlot(), 1);
+}
+
+TEST_F(OTAWorkerTest, CancelRacingUpdateStartNeverInstalls) {
+    gateDownload();
+    ASSERT_TRUE(worker.begin());
+
+    for (int i = 0; i < 100; i++) {
+        worker.post(WorkerCommand::CHECK);
+        ASSERT_TRUE(waitFor(worker, WorkerEventType::RELEASE_AVAILABLE));
+
+        // the cancel lands anywhere from before the token reset to the
+        // middle of the download, which the gate holds until it is posted....
+        gate.close();
+        worker.post(WorkerCommand::UPDATE);
+        if (i % 2 == 1) {
+            ASSERT_TRUE(waitFor(worker, WorkerEventType::UPDATE_STARTED));
+        }
+        worker.post(WorkerCommand::CANCEL);
+        gate.open();
+
+        ASSERT_TRUE(waitFor(worker, WorkerEventType::CANCELLED)) << "iteration " << i;
+        ASSERT_EQ(Shim::restartCount(), 0) << "iteration " << i;
+    }
+
+    EXPECT_EQ(Shim::Boot::bootSlot(), 0);
+}
+
+TEST_F(OTAWorkerTest, CancelAfterUpdateWasDequeuedStillCancels) {
+    ASSERT_TRUE(worker.begin());
+    worker.post(WorkerCommand::CHECK);
+    ASSERT_TRUE(waitFor(worker, WorkerEventType::RELEASE_AVAILABLE));
+
+    // posts the cancel right after the worker took the update off the queue,
+    // before it gets to reset the cancellation token....
+    struct Context {
+        Voyager::OTAWorker<>* worker;
+        std::atomic<bool> isArmed{true};
+    } context{&worker};
+    Shim::Queues::setReceiveHook(
+        [](const void* item, void* parameter) {
+            Context* context = static_cast<Context*>(parameter);
+            if (*static_cast<const WorkerCommand*>(item) == WorkerCommand::UPDATE && context->isArmed.exchange(false)) {
+                context->worker->post(WorkerCommand::CANCEL);
+            }
+        },
+        &context);
+
+    worker.post(WorkerCommand::UPDATE);
+    ASSERT_TRUE(waitFor(worker, WorkerEventType::CANCELLED));
+    Shim::Queues::setReceiveHook(nullptr);
+
+    EXPECT_FALSE(context.isArmed);
+    EXPECT_EQ(Shim::restartCount(), 0);
+    EXPECT_EQ(Shim::Boot::bootSlot(), 0);
+    for (const Shim::HttpRequest& request : Shim::MockServer::instance().requestLog()) {
+        EXPECT_NE(request.path, release.downloadPath());
+    }
+}
+
+TEST_F(OTAWorkerTest, UpdateCancelledMidDownloadLeavesImageUntouched) {
+    gateDownload();
+    ASSERT_TRUE(worker.begin());
+    worker.post(WorkerCommand::CHECK);
+    ASSERT_TRUE(waitFor(worker, WorkerEventType::RELEASE_AVAILABLE));
+
+    gate.close();
+    worker.post(WorkerCommand::UPDATE);
+    ASSERT_TRUE(gate.waitEntered());
+    worker.post(WorkerCommand::CANCEL);
+    gate.open();
+
+    ASSERT_TRUE(waitFor(worker, WorkerEventType::CANCELLED));
+    EXPECT_EQ(Shim::restartCount(), 0);
+    EXPECT_EQ(Shim::Boot::bootSlot(), 0);
+}
+
+TEST_F(OTAWorkerTest, CancelDoesNotSwallowStop) {
+    Shim::MockServer::instance().on(MockVoyager::LATEST_RELEASE_PATH, [this](const Shim::HttpRequest&) {
+        gate.pass();
+        return Shim::HttpResponse::json(200, MockVoyager::releaseJson(release));
+    });
+
+    gate.close();
+    ASSERT_TRUE(worker.begin());
+    worker.post(WorkerCommand::CHECK);
+    ASSERT_TRUE(gate.waitEntered());
+
+    // both jump the queue, the cancel ends up in front of the stop....
+    ASSERT_TRUE(worker.post(WorkerCommand::STOP));
+    ASSERT_TRUE(worker.post(WorkerCommand::CANCEL));
+    gate.open();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (worker.isRunning() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_FALSE(worker.isRunning());
+    EXPECT_TRUE(waitFor(worker, WorkerEventType::CANCELLED));
+}
+
+TEST_F(OTAWorkerTest, FailedUpdateReportsTheError) {
+    // the key is not read before the signature is looked for....
+    Voyager::SignatureVerifier verifier("");
+    worker.client().setSignatureVerifier(verifier);
+    ASSERT_TRUE(worker.begin());
+    worker.post(WorkerCommand::CHECK);
+    ASSERT_TRUE(waitFor(worker, WorkerEventType::RELEASE_AVAILABLE));
+
+    // the release is served without an x-signature header....
+    worker.post(WorkerCommand::UPDATE);
+    WorkerEvent event;
+    ASSERT_TRUE(waitFor(worker, WorkerEventType::UPDATE_FAILED, &event));
+    EXPECT_EQ(event.code, Voyager::UpdateError::SIGNATURE_MISSING);
+    EXPECT_EQ(worker.client().getLastError(), Voyager::UpdateError::SIGNATURE_MISSING);
+}
+
+TEST_F(OTAWorkerTest, RestartAfterStopLeaksNoQueue) {
+    size_t queues = Shim::Queues::count();
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(worker.begin());
+        ASSERT_TRUE(worker.post(WorkerCommand::STOP));
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (worker.isRunning() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_FALSE(worker.isRunning());
+    }
+
+    // only the queue of the last run is left, end() deletes it....
+    EXPECT_EQ(Shim::Queues::count(), queues + 1);
+    worker.end();
+    EXPECT_EQ(Shim::Queues::count(), queues);
+}
+
+TEST_F(OTAWorkerTest, EndWithoutBeginIsHarmless) {
+    worker.end();
+    EXPECT_FALSE(worker.isRunning());
+    EXPECT_FALSE(worker.post(WorkerCommand::CHECK));
+}
@@ -0,0 +1,163 @@
+// Accept negotiation of the release parsers, and JSON against MessagePack
+// release metadata: payload size, parse time and heap per parse.
+#define __ENABLE_DEVELOPMENT_MODE__ true
+
+#include <VoyagerOTA.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include "HeapTracker.h"
+#include "MockVoyager.h"
+
+using Voyager::VoyagerReleaseModel;
+
+namespace {
+    void expectSameRelease(const VoyagerReleaseModel& actual, const VoyagerReleaseModel& expected) {
+        EXPECT_EQ(actual.version, expected.version);
+        EXPECT_EQ(actual.releaseId, expected.releaseId);
+        EXPECT_EQ(actual.changeLog, expected.changeLog);
+        EXPECT_EQ(actual.releasedDate, expected.releasedDate);
+        EXPECT_EQ(actual.status, expected.status);
+        EXPECT_EQ(actual.hash, expected.hash);
+        EXPECT_EQ(actual.size, expected.size);
+        EXPECT_EQ(actual.prettySize, expected.prettySize);
+        EXPECT_EQ(actual.downloadURL, expected.downloadURL);
+    }
+}  // namespace
+
+class ParserTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Shim::reset();
+        MockVoyager::serve(release);
+    }
+
+    void TearDown() override { Shim::reset(); }
+
+    template <typename T_OTA>
+    std::optional<VoyagerReleaseModel> fetch(T_OTA& ota) {
+        ota.setBaseURL(MockVoyager::BASE_URL);
+        ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+        return ota.fetchLatestRelease();
+    }
+
+    MockVoyager::Release release;
+};
+
+TEST_F(ParserTest, DefaultParserSendsNoAcceptHeader) {
+    Voyager::OTA<> ota("1.0.0");
+    ASSERT_TRUE(fetch(ota).has_value());
+    EXPECT_FALSE(Shim::MockServer::instance().lastRequest().hasHeader("Accept"));
+
+    Voyager::OTA<Voyager::HTTPResponseData, VoyagerReleaseModel, Voyager::VoyagerJSONParser> staticOTA("1.0.0");
+    ASSERT_TRUE(fetch(staticOTA).has_value());
+    EXPECT_FALSE(Shim::MockServer::instance().lastRequest().hasHeader("Accept"));
+}
+
+TEST_F(ParserTest, MsgPackParserNegotiatesMessagePack) {
+    Voyager::OTA<> jsonOTA("1.0.0");
+    std::optional<VoyagerReleaseModel> expected = fetch(jsonOTA);
+    ASSERT_TRUE(expected.has_value());
+
+    Voyager::OTA<> ota("1.0.0", std::make_unique<Voyager::VoyagerMsgPackParser>());
+    std::optional<VoyagerReleaseModel> actual = fetch(ota);
+    ASSERT_TRUE(actual.has_value());
+    EXPECT_EQ(Shim::MockServer::instance().lastRequest().header("Accept"), "application/msgpack, application/json;q=0.5");
+    expectSameRelease(*actual, *expected);
+}
+
+TEST_F(ParserTest, MsgPackParserFallsBackToJson) {
+    Shim::MockServer::instance().on(MockVoyager::LATEST_RELEASE_PATH, [this](const Shim::HttpRequest&) {
+        return Shim::HttpResponse::json(200, MockVoyager::releaseJson(release));
+    });
+
+    Voyager::OTA<> ota("1.0.0", std::make_unique<Voyager::VoyagerMsgPackParser>());
+    std::optional<VoyagerReleaseModel> actual = fetch(ota);
+    ASSERT_TRUE(actual.has_value());
+    EXPECT_EQ(actual->version, String("1.1.0"));
+    EXPECT_EQ(actual->size, static_cast<int>(release.image.size()));
+}
+
+TEST_F(ParserTest, MalformedMsgPackIsRejected) {
+    std::string truncated = MockVoyager::releaseMsgPack(release);
+    truncated.resize(truncated.size() / 2);
+
+    Voyager::VoyagerMsgPackParser parser;
+    EXPECT_FALSE(parser.parse(String(truncated), 200).has_value());
+}
+
+// Payload on the wire, parse time and heap use of the two formats, for the
+// same release document. Only meaningful against the real ArduinoJson, the
+// stand-in neither parses nor allocates the way it does.
+TEST(ParserBenchmark, JsonAgainstMsgPack) {
+#if VOYAGER_ARDUINOJSON_STANDIN
+    GTEST_SKIP() << "built against the ArduinoJson stand-in";
+#endif
+    constexpr int ITERATIONS = 20000;
+
+    Shim::reset();
+    MockVoyager::Release release;
+    const String json(MockVoyager::releaseJson(release));
+    const String msgPack(MockVoyager::releaseMsgPack(release));
+
+    struct Result {
+        const char* name;
+        size_t payloadBytes;
+        uint64_t wireBytes;
+        double nanosPerParse;
+        double allocationsPerParse;
+        int64_t peakBytes;
+    };
+
+    auto measure = [&](const char* name, Voyager::IParser<>& parser, const String& payload, std::unique_ptr<Voyager::IParser<>> fetchParser) {
+        Result result{name, payload.length(), 0, 0, 0, 0};
+
+        // whole response on the wire, headers included....
+        Shim::MockServer::instance().reset();
+        MockVoyager::serve(release);
+        Voyager::OTA<> ota("1.0.0", std::move(fetchParser));
+        ota.setBaseURL(MockVoyager::BASE_URL);
+        ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+        EXPECT_TRUE(ota.fetchLatestRelease().has_value());
+        result.wireBytes = Shim::MockServer::instance().stats().bytesOut;
+
+        HeapTracker::reset();
+        EXPECT_TRUE(parser.parse(payload, 200).has_value());
+        HeapTracker::Stats heap = HeapTracker::stats();
+        result.allocationsPerParse = static_cast<double>(heap.allocations);
+        result.peakBytes = heap.peakBytes;
+
+        // keeps the parses from being optimised away....
+        volatile int sizes = 0;
+        auto startedAt = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; i++) {
+            sizes = sizes + parser.parse(payload, 200)->size;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - startedAt;
+        result.nanosPerParse = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / ITERATIONS;
+        return result;
+    };
+
+    Voyager::VoyagerJSONParser jsonParser;
+    Voyager::VoyagerMsgPackParser msgPackParser;
+    Result results[] = {
+        measure("json", jsonParser, json, std::make_unique<Voyager::VoyagerJSONParser>()),
+        measure("msgpack", msgPackParser, msgPack, std::make_unique<Voyager::VoyagerMsgPackParser>()),
+    };
+
+    printf("ArduinoJson %s\n", ARDUINOJSON_VERSION);
+    printf("%-8s %9s %10s %12s %13s %11s\n", "format", "payload B", "response B", "ns/parse", "allocs/parse", "peak heap B");
+    for (const Result& result : results) {
+        printf("%-8s %9zu %10" PRIu64 " %12.0f %13.0f %11" PRId64 "\n",
+               result.name,
+               result.payloadBytes,
+               result.wireBytes,
+               result.nanosPerParse,
+               result.allocationsPerParse,
+               result.peakBytes);
+    }
+
+    EXPECT_LT(results[1].payloadBytes, results[0].payloadBytes);
+    EXPECT_LT(results[1].wireBytes, results[0].wireBytes);
+    Shim::reset();
+}
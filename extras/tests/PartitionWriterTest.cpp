@@ -0,0 +1,223 @@
+// PartitionWriter on the modelled flash: block alignment on encrypted
+// partitions, erases left to the write path, and the end-to-end time of an
+// update with and without pre-erase.
+#define __ENABLE_DEVELOPMENT_MODE__ true
+
+#include <VoyagerOTA.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "MockVoyager.h"
+
+namespace {
+    void useEncryptedFlash() {
+        Shim::Flash::Config config;
+        config.isEncrypted = true;
+        Shim::Flash::configure(config);
+    }
+
+    // Writes the image in chunks of the given sizes, cycling through them.
+    bool writeInChunks(Voyager::PartitionWriter& writer, std::vector<uint8_t> image, const std::vector<size_t>& chunks) {
+        size_t offset = 0;
+        for (size_t i = 0; offset < image.size(); i++) {
+            size_t length = std::min(chunks[i % chunks.size()], image.size() - offset);
+            if (writer.write(image.data() + offset, length) != length) {
+                return false;
+            }
+            offset += length;
+        }
+        return true;
+    }
+
+    // Sectors the last update erased in the write path, from its log line.
+    int stalledErases(const std::string& output) {
+        size_t at = output.rfind(" flash sectors were erased in the write path");
+        if (at == std::string::npos) {
+            return -1;
+        }
+        return atoi(output.c_str() + output.rfind("VOYAGER_OTA ", at) + strlen("VOYAGER_OTA "));
+    }
+}  // namespace
+
+class PartitionWriterTest : public ::testing::Test {
+protected:
+    void SetUp() override { Shim::reset(); }
+
+    void TearDown() override { Shim::reset(); }
+
+    std::vector<uint8_t> image = Shim::makeFirmwareImage(16 * Shim::Flash::SECTOR_SIZE + 100, 5);
+    Voyager::PartitionWriter writer;
+};
+
+TEST_F(PartitionWriterTest, OddChunksOnEncryptedFlash) {
+    useEncryptedFlash();
+
+    ASSERT_TRUE(writer.begin(image.size()));
+    ASSERT_TRUE(writeInChunks(writer, image, {1, 7, 15, 16, 17, 1000, 4093}));
+    ASSERT_TRUE(writer.end()) << writer.getError();
+
+    const std::vector<uint8_t>& flashed = Shim::Flash::contents(1);
+    EXPECT_TRUE(std::equal(image.begin(), image.end(), flashed.begin()));
+    // the tail block is padded with erased bytes....
+    EXPECT_EQ(flashed[image.size()], 0xFF);
+    EXPECT_EQ(Shim::Flash::stats().rejectedWrites, 0u);
+    EXPECT_EQ(Shim::Flash::stats().unerasedWrites, 0u);
+    EXPECT_EQ(Shim::Boot::bootSlot(), 1);
+}
+
+TEST_F(PartitionWriterTest, OddChunksOnPlainFlash) {
+    ASSERT_TRUE(writer.begin(image.size()));
+    ASSERT_TRUE(writeInChunks(writer, image, {3, 4096, 11}));
+    ASSERT_TRUE(writer.end()) << writer.getError();
+
+    EXPECT_TRUE(std::equal(image.begin(), image.end(), Shim::Flash::contents(1).begin()));
+    EXPECT_EQ(Shim::Flash::stats().bytesWritten, image.size());
+}
+
+TEST_F(PartitionWriterTest, IncompleteImageIsNotFlushed) {
+    useEncryptedFlash();
+
+    ASSERT_TRUE(writer.begin(image.size()));
+    ASSERT_TRUE(writeInChunks(writer, std::vector<uint8_t>(image.begin(), image.end() - 5), {1000}));
+    EXPECT_FALSE(writer.end());
+    EXPECT_EQ(writer.getError(), Voyager::PartitionError::INCOMPLETE);
+    EXPECT_EQ(Shim::Boot::bootSlot(), 0);
+}
+
+TEST_F(PartitionWriterTest, HeaderIsFlashedOnlyByEnd) {
+    useEncryptedFlash();
+
+    ASSERT_TRUE(writer.begin(image.size()));
+    ASSERT_TRUE(writeInChunks(writer, image, {7, 4096}));
+    // everything but the header block and the pending tail block is on the
+    // flash....
+    constexpr size_t BLOCK = Voyager::PartitionWriter::ENCRYPTED_BLOCK_SIZE;
+    const std::vector<uint8_t>& flashed = Shim::Flash::contents(1);
+    EXPECT_TRUE(std::all_of(flashed.begin(), flashed.begin() + BLOCK, [](uint8_t byte) { return byte == 0xFF; }));
+    EXPECT_TRUE(std::equal(image.begin() + BLOCK, image.end() - image.size() % BLOCK, flashed.begin() + BLOCK));
+
+    ASSERT_TRUE(writer.end()) << writer.getError();
+    EXPECT_TRUE(std::equal(image.begin(), image.end(), Shim::Flash::contents(1).begin()));
+    EXPECT_EQ(Shim::Flash::stats().rejectedWrites, 0u);
+}
+
+TEST_F(PartitionWriterTest, MD5MismatchLeavesNoHeader) {
+    ASSERT_TRUE(writer.begin(image.size()));
+    ASSERT_TRUE(writer.setMD5(Shim::md5Hex(Shim::makeFirmwareImage(image.size(), 8)).c_str()));
+    ASSERT_TRUE(writeInChunks(writer, image, {4096}));
+
+    EXPECT_FALSE(writer.end());
+    EXPECT_EQ(writer.getError(), Voyager::PartitionError::MD5_MISMATCH);
+    EXPECT_EQ(Shim::Flash::contents(1)[0], 0xFF);
+    EXPECT_EQ(Shim::Boot::bootSlot(), 0);
+}
+
+TEST_F(PartitionWriterTest, WritePastTheImageSetsAnError) {
+    ASSERT_TRUE(writer.begin(100));
+    EXPECT_EQ(writer.write(image.data(), 101), 0u);
+    EXPECT_EQ(writer.getError(), Voyager::PartitionError::TOO_LARGE);
+}
+
+TEST_F(PartitionWriterTest, EraseAheadLeavesNothingToTheWritePath) {
+    ASSERT_TRUE(writer.begin(image.size()));
+
+    // an idle gap after every write, as on a link slower than the flash....
+    for (size_t offset = 0; offset < image.size(); offset += 1000) {
+        while (writer.eraseAhead()) {
+        }
+        size_t length = std::min<size_t>(1000, image.size() - offset);
+        ASSERT_EQ(writer.write(image.data() + offset, length), length);
+    }
+
+    EXPECT_EQ(writer.getStalledErases(), 0u);
+    EXPECT_TRUE(writer.end());
+}
+
+TEST_F(PartitionWriterTest, WritesWithoutIdleGapsStallOnEverySector) {
+    ASSERT_TRUE(writer.begin(image.size()));
+    ASSERT_TRUE(writeInChunks(writer, image, {4096}));
+
+    // all but the first, which begin() erased....
+    EXPECT_EQ(writer.getStalledErases(), 16u);
+    EXPECT_TRUE(writer.end());
+}
+
+TEST_F(PartitionWriterTest, EncryptedDownloadInOddChunks) {
+    useEncryptedFlash();
+
+    MockVoyager::Release release;
+    release.image = image;
+    MockVoyager::serve(release, 10007);
+
+    Voyager::OTA<> ota("1.0.0");
+    ota.setBaseURL(MockVoyager::BASE_URL);
+    ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+    ota.setFlashPreErase(true);
+    ota.setDownloadURL(release.downloadURL());
+    Shim::esp().throwOnRestart = false;
+    ota.performUpdate();
+
+    EXPECT_EQ(ota.getLastUpdateResult(), HTTP_UPDATE_OK);
+    EXPECT_TRUE(std::equal(image.begin(), image.end(), Shim::Flash::contents(1).begin()));
+    EXPECT_EQ(Shim::Flash::stats().rejectedWrites, 0u);
+    // 10 KB/s leaves plenty of gaps to erase in....
+    EXPECT_EQ(stalledErases(Shim::takeSerialOutput()), 0);
+}
+
+// End-to-end time of a 1 MB update over links of different speeds, erasing
+// right before each write (Update) against erasing ahead in idle gaps
+// (PartitionWriter), on a flash modelled at 45 ms per sector erase and 3 us
+// per byte written. The sender stalls while its receive window is full.
+TEST(FlashSimulationBenchmark, PreEraseAgainstEraseOnWrite) {
+    constexpr size_t IMAGE_SIZE = 1024 * 1024;
+    const uint32_t rates[] = {25 * 1024, 50 * 1024, 100 * 1024, 400 * 1024, 0};
+
+    struct Result {
+        double seconds;
+        double eraseSeconds;
+        int stalledErases;
+    };
+
+    auto simulate = [&](uint32_t rate, bool isPreEraseEnabled) {
+        Shim::reset();
+        Shim::esp().throwOnRestart = false;
+        MockVoyager::Release release;
+        release.image = Shim::makeFirmwareImage(IMAGE_SIZE, 9);
+        MockVoyager::serve(release, rate);
+
+        Voyager::OTA<> ota("1.0.0");
+        ota.setBaseURL(MockVoyager::BASE_URL);
+        ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+        ota.setFlashPreErase(isPreEraseEnabled);
+        ota.setDownloadURL(release.downloadURL());
+
+        uint64_t startedAt = Shim::Clock::nowMicros();
+        ota.performUpdate();
+        EXPECT_EQ(ota.getLastUpdateResult(), HTTP_UPDATE_OK);
+        Result result;
+        result.seconds = static_cast<double>(Shim::Clock::nowMicros() - startedAt) / 1e6;
+        result.eraseSeconds = static_cast<double>(Shim::Flash::stats().eraseMicros) / 1e6;
+        result.stalledErases = isPreEraseEnabled ? stalledErases(Shim::takeSerialOutput()) : static_cast<int>(IMAGE_SIZE / Shim::Flash::SECTOR_SIZE);
+        return result;
+    };
+
+    printf("%-10s %12s %14s %10s %14s\n", "link", "erase on write", "pre-erase", "saved", "stalled erases");
+    for (uint32_t rate : rates) {
+        Result onWrite = simulate(rate, false);
+        Result preErase = simulate(rate, true);
+        std::string link = rate == 0 ? std::string("unlimited") : std::to_string(rate / 1024) + " KB/s";
+        printf("%-10s %12.2f s %12.2f s %8.1f %% %10d/%zu\n",
+               link.c_str(),
+               onWrite.seconds,
+               preErase.seconds,
+               100.0 * (onWrite.seconds - preErase.seconds) / onWrite.seconds,
+               preErase.stalledErases,
+               IMAGE_SIZE / Shim::Flash::SECTOR_SIZE);
+
+        EXPECT_NEAR(preErase.eraseSeconds, onWrite.eraseSeconds, 0.05);
+        EXPECT_LE(preErase.seconds, onWrite.seconds * 1.01);
+    }
+    Shim::reset();
+}
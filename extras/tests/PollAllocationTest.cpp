@@ -0,0 +1,79 @@
+// Heap allocations of one fetchLatestRelease() poll: the endpoint is composed
+// once in setBaseURL() and the configured headers are not copied, so nothing
+// is allocated before the request goes out.
+#define __ENABLE_DEVELOPMENT_MODE__ true
+
+#include <VoyagerOTA.hpp>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <memory>
+#include "HeapTracker.h"
+#include "MockVoyager.h"
+
+class PollAllocationTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Shim::reset();
+        MockVoyager::serve(release);
+
+        // heap use of the library at the moment the request reaches the
+        // server....
+        Shim::MockServer::instance().on(MockVoyager::LATEST_RELEASE_PATH, [this](const Shim::HttpRequest& request) {
+            atRequest = HeapTracker::stats();
+            return Shim::HttpResponse::json(200, MockVoyager::releaseJson(release));
+        });
+    }
+
+    void TearDown() override { Shim::reset(); }
+
+    template <typename T_OTA>
+    HeapTracker::Stats poll(T_OTA& ota) {
+        HeapTracker::reset();
+        EXPECT_TRUE(ota.fetchLatestRelease().has_value());
+        return HeapTracker::stats();
+    }
+
+    MockVoyager::Release release;
+    HeapTracker::Stats atRequest;
+};
+
+TEST_F(PollAllocationTest, NothingIsAllocatedBeforeTheRequest) {
+    Voyager::OTA<> ota("1.0.0");
+    ota.setBaseURL(MockVoyager::BASE_URL);
+    ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+
+    poll(ota);
+    EXPECT_EQ(atRequest.allocations, 0u);
+    Shim::HttpRequest request = Shim::MockServer::instance().lastRequest();
+    EXPECT_EQ(request.path + "?" + request.query, __VoyagerApi__::Endpoints::LATEST_STAGING_RELEASE.data());
+}
+
+TEST_F(PollAllocationTest, AcceptHeaderIsNotCopiedIn) {
+    Voyager::OTA<> ota("1.0.0", std::make_unique<Voyager::VoyagerMsgPackParser>());
+    ota.setBaseURL(MockVoyager::BASE_URL);
+    ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+
+    poll(ota);
+    EXPECT_EQ(atRequest.allocations, 0u);
+    EXPECT_TRUE(Shim::MockServer::instance().lastRequest().hasHeader("Accept"));
+}
+
+TEST_F(PollAllocationTest, EveryPollCostsTheSame) {
+    Voyager::OTA<> ota("1.0.0");
+    ota.setBaseURL(MockVoyager::BASE_URL);
+    ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+
+    HeapTracker::Stats first = poll(ota);
+    for (int i = 0; i < 10; i++) {
+        HeapTracker::Stats next = poll(ota);
+        EXPECT_EQ(next.allocations, first.allocations);
+        EXPECT_EQ(next.allocatedBytes, first.allocatedBytes);
+        // the release model returned by the poll is gone again....
+        EXPECT_EQ(next.liveBytes, 0);
+    }
+
+    printf("per poll: %" PRIu64 " allocations, %" PRIu64 " bytes, peak %" PRId64 " bytes, none before the request\n",
+           first.allocations,
+           first.allocatedBytes,
+           first.peakBytes);
+}
@@ -0,0 +1,107 @@
+// Edges of the partition-size and heap checks run before an update.
+#define __ENABLE_DEVELOPMENT_MODE__ true
+
+#include <VoyagerOTA.hpp>
+#include <gtest/gtest.h>
+#include "MockVoyager.h"
+
+using Voyager::PreflightVerdict;
+
+class PreflightTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Shim::reset();
+        ota.setBaseURL(MockVoyager::BASE_URL);
+        ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+        ota.setMinimumFreeHeap(MINIMUM_HEAP);
+    }
+
+    void TearDown() override { Shim::reset(); }
+
+    // Runs performUpdate() and returns the code passed to onError, 0 if none.
+    int performUpdate() {
+        int errorCode = 0;
+        ota.attachEventCallbacks([] {}, [](int, int) {}, [] {}, [&errorCode](int code) { errorCode = code; });
+        ota.performUpdate();
+        return errorCode;
+    }
+
+    static constexpr uint32_t MINIMUM_HEAP = 48 * 1024;
+    static constexpr uint32_t PARTITION_SIZE = 0x140000;
+
+    Voyager::OTA<> ota{"1.0.0"};
+};
+
+TEST_F(PreflightTest, ImageFillingThePartitionFits) {
+    EXPECT_EQ(ota.preflight(PARTITION_SIZE).verdict, PreflightVerdict::OK);
+    EXPECT_EQ(ota.preflight(PARTITION_SIZE + 1).verdict, PreflightVerdict::IMAGE_TOO_LARGE);
+    EXPECT_EQ(ota.preflight(1).verdict, PreflightVerdict::OK);
+}
+
+TEST_F(PreflightTest, LargestFreeBlockDecidesHeapVerdict) {
+    Shim::esp().maxAllocHeap = MINIMUM_HEAP;
+    EXPECT_EQ(ota.preflight(1024).verdict, PreflightVerdict::OK);
+
+    Shim::esp().maxAllocHeap = MINIMUM_HEAP - 1;
+    EXPECT_EQ(ota.preflight(1024).verdict, PreflightVerdict::INSUFFICIENT_HEAP);
+
+    // plenty of heap in total, but fragmented....
+    Shim::esp().freeHeap = 180 * 1024;
+    Shim::esp().maxAllocHeap = 30 * 1024;
+    Voyager::PreflightResult result = ota.preflight(1024);
+    EXPECT_EQ(result.verdict, PreflightVerdict::INSUFFICIENT_HEAP);
+    EXPECT_EQ(result.freeHeap, 180u * 1024);
+    EXPECT_EQ(result.maxAllocHeap, 30u * 1024);
+}
+
+TEST_F(PreflightTest, MissingOtaPartitionIsReported) {
+    Shim::Flash::Config config;
+    config.hasOtaPartitions = false;
+    Shim::Flash::configure(config);
+
+    EXPECT_EQ(ota.preflight(1024).verdict, PreflightVerdict::NO_OTA_PARTITION);
+}
+
+TEST_F(PreflightTest, UnknownSizeIsAskedWithHead) {
+    MockVoyager::Release release;
+    MockVoyager::serve(release);
+    ota.setDownloadURL(release.downloadURL());
+
+    Voyager::PreflightResult result = ota.preflight();
+    EXPECT_EQ(Shim::MockServer::instance().lastRequest().method, "HEAD");
+    EXPECT_EQ(result.verdict, PreflightVerdict::OK);
+    EXPECT_EQ(result.imageSize, static_cast<int>(release.image.size()));
+
+    // a download URL that refuses HEAD is not a rejection....
+    Shim::MockServer::instance().on(release.downloadPath(), [](const Shim::HttpRequest&) { return Shim::HttpResponse::withStatus(403); }, "HEAD");
+    result = ota.preflight();
+    EXPECT_EQ(result.verdict, PreflightVerdict::UNKNOWN_SIZE);
+    EXPECT_TRUE(result.isOK());
+}
+
+TEST_F(PreflightTest, RejectionsReportTheirOwnErrorCode) {
+    MockVoyager::Release release;
+    release.image = Shim::makeFirmwareImage(PARTITION_SIZE + Shim::Flash::SECTOR_SIZE);
+    MockVoyager::serve(release);
+    ASSERT_TRUE(ota.fetchLatestRelease().has_value());
+    ota.setDownloadURL(release.downloadURL());
+
+    EXPECT_EQ(performUpdate(), HTTP_UE_TOO_LESS_SPACE);
+
+    Shim::esp().maxAllocHeap = 16 * 1024;
+    EXPECT_EQ(performUpdate(), Voyager::UpdateError::INSUFFICIENT_HEAP);
+    EXPECT_NE(Shim::takeSerialOutput().find("free heap 204800 bytes, largest block 16384 bytes"), std::string::npos);
+
+    Shim::esp().maxAllocHeap = 110 * 1024;
+    Shim::Flash::Config config;
+    config.hasOtaPartitions = false;
+    Shim::Flash::configure(config);
+    EXPECT_EQ(performUpdate(), HTTP_UE_NO_PARTITION);
+
+    // nothing was downloaded and the flash was never touched....
+    for (const Shim::HttpRequest& request : Shim::MockServer::instance().requestLog()) {
+        EXPECT_NE(request.path, release.downloadPath());
+    }
+    EXPECT_EQ(Shim::Flash::stats().sectorsErased, 0u);
+    EXPECT_EQ(ota.getLastUpdateResult(), HTTP_UPDATE_FAILED);
+}
@@ -0,0 +1,259 @@
+// ReleaseCache decisions, eviction and NVS layout, and which update
+// outcomes the OTA client records as failures.
+#define __ENABLE_DEVELOPMENT_MODE__ true
+
+#include <VoyagerOTA.hpp>
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <string>
+#include "MockVoyager.h"
+
+using Voyager::ReleaseCache;
+using Voyager::ReleaseDecision;
+using Voyager::ReleaseOutcome;
+using Voyager::ReleaseRecord;
+
+namespace {
+    constexpr const char* NAMESPACE = "voyager-ota";
+    constexpr size_t CAPACITY = VOYAGER_OTA_RELEASE_CACHE_CAPACITY;
+
+    ReleaseRecord makeRelease(int index, const char* hash = "hash") {
+        return ReleaseRecord(String("1.0.") + String(index), String("release-") + String(index), hash, 1024);
+    }
+
+    size_t storedBlobLength() {
+        Preferences preferences;
+        if (!preferences.begin(NAMESPACE, true)) {
+            return 0;
+        }
+        size_t length = preferences.getBytesLength("releases");
+        preferences.end();
+        return length;
+    }
+}  // namespace
+
+class ReleaseCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override { Shim::reset(); }
+
+    void TearDown() override { Shim::reset(); }
+};
+
+TEST_F(ReleaseCacheTest, FreshDeviceBeginsEmpty) {
+    ReleaseCache cache;
+    ASSERT_TRUE(cache.begin());
+    EXPECT_EQ(cache.decide(makeRelease(1)), ReleaseDecision::UNKNOWN);
+}
+
+TEST_F(ReleaseCacheTest, DecisionFollowsLastOutcome) {
+    ReleaseCache cache;
+    ASSERT_TRUE(cache.begin());
+    cache.setMaxFailures(2);
+
+    cache.record(makeRelease(1), ReleaseOutcome::INSTALLED);
+    EXPECT_EQ(cache.decide(makeRelease(1)), ReleaseDecision::ALREADY_INSTALLED);
+
+    cache.record(makeRelease(2), ReleaseOutcome::DEFERRED);
+    EXPECT_EQ(cache.decide(makeRelease(2)), ReleaseDecision::RETRY);
+
+    cache.record(makeRelease(3), ReleaseOutcome::FAILED);
+    EXPECT_EQ(cache.decide(makeRelease(3)), ReleaseDecision::RETRY);
+    // a deferral in between does not reset the count....
+    cache.record(makeRelease(3), ReleaseOutcome::DEFERRED);
+    cache.record(makeRelease(3), ReleaseOutcome::FAILED);
+    EXPECT_EQ(cache.decide(makeRelease(3)), ReleaseDecision::KNOWN_BAD);
+    EXPECT_EQ(cache.find(makeRelease(3))->failures, 2);
+
+    // same version and id, different image....
+    EXPECT_EQ(cache.decide(makeRelease(3, "other-hash")), ReleaseDecision::UNKNOWN);
+}
+
+TEST_F(ReleaseCacheTest, EvictsLeastRecentlyWritten) {
+    ReleaseCache cache;
+    ASSERT_TRUE(cache.begin());
+
+    for (size_t i = 0; i < CAPACITY; i++) {
+        cache.record(makeRelease(static_cast<int>(i)), ReleaseOutcome::DEFERRED);
+    }
+    // touching the oldest makes release 1 the eviction candidate....
+    cache.record(makeRelease(0), ReleaseOutcome::DEFERRED);
+    cache.record(makeRelease(100), ReleaseOutcome::INSTALLED);
+
+    EXPECT_NE(cache.find(makeRelease(0)), nullptr);
+    EXPECT_EQ(cache.find(makeRelease(1)), nullptr);
+    EXPECT_NE(cache.find(makeRelease(100)), nullptr);
+    for (size_t i = 2; i < CAPACITY; i++) {
+        EXPECT_NE(cache.find(makeRelease(static_cast<int>(i))), nullptr) << "release " << i;
+    }
+}
+
+TEST_F(ReleaseCacheTest, RecordsSurviveReboot) {
+    {
+        ReleaseCache cache;
+        ASSERT_TRUE(cache.begin());
+        cache.record(makeRelease(1), ReleaseOutcome::FAILED, 4096);
+        cache.record(makeRelease(2), ReleaseOutcome::INSTALLED);
+    }
+
+    ReleaseCache cache;
+    ASSERT_TRUE(cache.begin());
+    const ReleaseRecord* record = cache.find(makeRelease(1));
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(record->outcome, ReleaseOutcome::FAILED);
+    EXPECT_EQ(record->downloadedBytes, 4096u);
+    EXPECT_EQ(record->failures, 1);
+
+    // new records keep counting from the persisted sequence....
+    cache.record(makeRelease(3), ReleaseOutcome::DEFERRED);
+    EXPECT_GT(cache.find(makeRelease(3))->sequence, cache.find(makeRelease(2))->sequence);
+}
+
+TEST_F(ReleaseCacheTest, RecordLayoutIsStable) {
+    static_assert(std::is_trivially_copyable_v<ReleaseRecord>, "records are stored as raw bytes");
+    EXPECT_EQ(offsetof(ReleaseRecord, key), 0u);
+    EXPECT_EQ(offsetof(ReleaseRecord, sequence), 4u);
+    EXPECT_EQ(offsetof(ReleaseRecord, version), 8u);
+    EXPECT_EQ(offsetof(ReleaseRecord, releaseId), 32u);
+    EXPECT_EQ(offsetof(ReleaseRecord, hash), 72u);
+    EXPECT_EQ(offsetof(ReleaseRecord, size), 144u);
+    EXPECT_EQ(offsetof(ReleaseRecord, downloadedBytes), 148u);
+    EXPECT_EQ(offsetof(ReleaseRecord, outcome), 152u);
+    EXPECT_EQ(offsetof(ReleaseRecord, failures), 153u);
+    EXPECT_EQ(sizeof(ReleaseRecord), 156u);
+
+    ReleaseCache cache;
+    ASSERT_TRUE(cache.begin());
+    cache.record(makeRelease(1), ReleaseOutcome::INSTALLED);
+    EXPECT_EQ(storedBlobLength(), CAPACITY * sizeof(ReleaseRecord));
+}
+
+TEST_F(ReleaseCacheTest, BlobOfAnotherLayoutIsDiscarded) {
+    Preferences preferences;
+    ASSERT_TRUE(preferences.begin(NAMESPACE, false));
+    std::string stale(CAPACITY * sizeof(ReleaseRecord) - 4, '\x5A');
+    preferences.putBytes("releases", stale.data(), stale.size());
+    preferences.end();
+
+    ReleaseCache cache;
+    ASSERT_TRUE(cache.begin());
+    EXPECT_EQ(cache.decide(makeRelease(1)), ReleaseDecision::UNKNOWN);
+}
+
+TEST_F(ReleaseCacheTest, LongFieldsKeepTheirHeadAndHash) {
+    ReleaseRecord record(String(std::string(100, 'v').c_str()), "id", "hash");
+    EXPECT_EQ(strlen(record.version), sizeof(record.version) - 1);
+    EXPECT_EQ(record.version[sizeof(record.version) - 10], '~');
+    EXPECT_TRUE(record.isSameRelease(ReleaseRecord(String(std::string(100, 'v').c_str()), "id", "hash")));
+
+    // a version that fits is stored as is....
+    EXPECT_STREQ(ReleaseRecord("1.2.3-rc.1+build.123456", "id").version, "1.2.3-rc.1+build.123456");
+}
+
+TEST_F(ReleaseCacheTest, LongVersionsDifferingInTheTailStayApart) {
+    ReleaseCache cache;
+    ASSERT_TRUE(cache.begin());
+    ReleaseRecord nightly("2.0.0-nightly.20261017+sha.0a1b2c3", "id", "hash");
+    ReleaseRecord next("2.0.0-nightly.20261018+sha.4d5e6f7", "id", "hash");
+
+    cache.record(nightly, ReleaseOutcome::INSTALLED);
+    EXPECT_FALSE(nightly.isSameRelease(next));
+    EXPECT_EQ(cache.decide(next), ReleaseDecision::UNKNOWN);
+}
+
+TEST_F(ReleaseCacheTest, InstallResetsFailures) {
+    ReleaseCache cache;
+    ASSERT_TRUE(cache.begin());
+
+    cache.record(makeRelease(1), ReleaseOutcome::FAILED);
+    cache.record(makeRelease(1), ReleaseOutcome::FAILED);
+    cache.record(makeRelease(1), ReleaseOutcome::INSTALLED);
+    EXPECT_EQ(cache.find(makeRelease(1))->failures, 0);
+}
+
+// Outcomes recorded by performUpdate(): only a bad image is a failure.
+class ReleaseOutcomeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Shim::reset();
+        Shim::esp().throwOnRestart = false;
+
+        ASSERT_TRUE(cache.begin());
+        ota.setBaseURL(MockVoyager::BASE_URL);
+        ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+        ota.setReleaseCache(cache);
+        ota.attachEventCallbacks([] {}, [](int, int) {}, [] {}, [](int) {});
+    }
+
+    void TearDown() override { Shim::reset(); }
+
+    // Fetches the release, then downloads it with the given response.
+    ReleaseRecord update(Shim::HttpResponse response) {
+        MockVoyager::serve(release);
+        Shim::MockServer::instance().on(release.downloadPath(), [response](const Shim::HttpRequest&) { return response; });
+        payload = ota.fetchLatestRelease();
+        EXPECT_TRUE(payload.has_value());
+        ota.setDownloadURL(release.downloadURL());
+        ota.performUpdate();
+
+        const ReleaseRecord* record = cache.find(ReleaseRecord(release.version.c_str(), release.id.c_str(), Shim::md5Hex(release.image).c_str(), static_cast<int>(release.image.size())));
+        EXPECT_NE(record, nullptr);
+        return record != nullptr ? *record : ReleaseRecord();
+    }
+
+    Shim::HttpResponse image() const { return Shim::HttpResponse::binary(std::string(release.image.begin(), release.image.end())); }
+
+    MockVoyager::Release release;
+    ReleaseCache cache;
+    Voyager::OTA<> ota{"1.0.0"};
+    std::optional<Voyager::DefaultReleaseModel> payload;
+};
+
+TEST_F(ReleaseOutcomeTest, TransientErrorsAreDeferred) {
+    Shim::HttpResponse dropped = image();
+    dropped.dropAfter = 10000;
+
+    for (const Shim::HttpResponse& response : {Shim::HttpResponse::withStatus(503), Shim::HttpResponse::withStatus(404), dropped}) {
+        ReleaseRecord record = update(response);
+        EXPECT_EQ(record.outcome, ReleaseOutcome::DEFERRED) << "status " << response.status;
+        EXPECT_EQ(record.failures, 0);
+    }
+    EXPECT_EQ(ota.getReleaseDecision(*payload), ReleaseDecision::RETRY);
+}
+
+TEST_F(ReleaseOutcomeTest, CorruptImageIsFailedUntilKnownBad) {
+    cache.setMaxFailures(2);
+    Shim::HttpResponse corrupt = image();
+    corrupt.header("x-MD5", Shim::md5Hex(Shim::makeFirmwareImage(release.image.size(), 8)));
+
+    ReleaseRecord record = update(corrupt);
+    EXPECT_EQ(record.outcome, ReleaseOutcome::FAILED);
+    EXPECT_EQ(ota.getReleaseDecision(*payload), ReleaseDecision::RETRY);
+
+    std::string badMagic(release.image.begin(), release.image.end());
+    badMagic[0] = 0;
+    record = update(Shim::HttpResponse::binary(badMagic));
+    EXPECT_EQ(record.outcome, ReleaseOutcome::FAILED);
+    EXPECT_EQ(record.failures, 2);
+    EXPECT_EQ(ota.getReleaseDecision(*payload), ReleaseDecision::KNOWN_BAD);
+}
+
+TEST_F(ReleaseOutcomeTest, InstalledReleaseIsRemembered) {
+    ReleaseRecord record = update(image());
+    EXPECT_EQ(record.outcome, ReleaseOutcome::INSTALLED);
+    EXPECT_EQ(record.downloadedBytes, release.image.size());
+    EXPECT_EQ(ota.getReleaseDecision(*payload), ReleaseDecision::ALREADY_INSTALLED);
+}
+
+TEST(UpdateErrorTest, OnlyImageProblemsAreIntegrityFailures) {
+    using Voyager::UpdateError::isIntegrityFailure;
+    for (int code : {Voyager::UpdateError::SIGNATURE_INVALID, Voyager::UpdateError::SIGNATURE_MISSING, HTTP_UE_SERVER_FAULTY_MD5,
+                     UPDATE_ERROR_MD5, UPDATE_ERROR_MAGIC_BYTE, UPDATE_ERROR_ACTIVATE, Voyager::PartitionError::MD5_MISMATCH,
+                     Voyager::PartitionError::MAGIC_MISMATCH, Voyager::PartitionError::ACTIVATE_FAILED}) {
+        EXPECT_TRUE(isIntegrityFailure(code)) << code;
+    }
+    for (int code : {Voyager::UpdateError::CANCELLED, Voyager::UpdateError::STREAM_TIMEOUT, HTTP_UE_SERVER_WRONG_HTTP_CODE,
+                     HTTP_UE_SERVER_FILE_NOT_FOUND, HTTP_UE_TOO_LESS_SPACE, UPDATE_ERROR_WRITE, UPDATE_ERROR_ERASE,
+                     UPDATE_ERROR_STREAM, Voyager::PartitionError::WRITE_FAILED, Voyager::PartitionError::INCOMPLETE}) {
+        EXPECT_FALSE(isIntegrityFailure(code)) << code;
+    }
+}
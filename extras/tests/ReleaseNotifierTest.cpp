@@ -0,0 +1,237 @@
+// ReleaseNotifier against a server-sent events stream on the mock server,
+// and what it costs a device per day compared to polling.
+#define __ENABLE_DEVELOPMENT_MODE__ true
+
+#include <ReleaseNotifier.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "MockVoyager.h"
+
+namespace {
+    constexpr const char* EVENTS_PATH = "/internal/api/v1/releases/events";
+    constexpr uint64_t SECOND = 1000000;
+
+    Shim::HttpResponse eventStream(std::vector<Shim::HttpResponse::Push> pushes, int64_t closeAfterMicros = -1) {
+        Shim::HttpResponse response = Shim::HttpResponse::withStatus(200);
+        response.header("Content-Type", "text/event-stream");
+        response.contentLength = -1;
+        response.pushes = std::move(pushes);
+        response.closeAfterMicros = closeAfterMicros;
+        return response;
+    }
+
+    // Polls every stepMs for the given time, returns the seconds at which
+    // poll() asked for a fetch.
+    std::vector<uint32_t> run(Voyager::ReleaseNotifier& notifier, uint32_t seconds, uint32_t stepMs = 100) {
+        std::vector<uint32_t> fetches;
+        uint32_t endAt = millis() + seconds * 1000;
+        while (static_cast<int32_t>(millis() - endAt) < 0) {
+            if (notifier.poll()) {
+                fetches.push_back(millis() / 1000);
+            }
+            delay(stepMs);
+        }
+        return fetches;
+    }
+}  // namespace
+
+class ReleaseNotifierTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Shim::reset();
+        notifier.setURL(std::string(MockVoyager::BASE_URL).append(EVENTS_PATH).c_str(), {{"x-api-key", MockVoyager::API_KEY}});
+        notifier.setPollInterval(15 * 60 * 1000, 0);
+    }
+
+    void TearDown() override {
+        notifier.end();
+        Shim::reset();
+    }
+
+    void serveEvents(std::vector<Shim::HttpResponse::Push> pushes, int64_t closeAfterMicros = -1) {
+        Shim::MockServer::instance().on(EVENTS_PATH, [pushes, closeAfterMicros](const Shim::HttpRequest&) { return eventStream(pushes, closeAfterMicros); });
+    }
+
+    Voyager::ReleaseNotifier notifier;
+};
+
+TEST_F(ReleaseNotifierTest, AnnouncementTriggersFetch) {
+    serveEvents({
+        {20 * SECOND, ": keep-alive\n\n"},
+        {40 * SECOND, "event: release\ndata: {\"version\":\"1.1.0\"}\n\n"},
+        {60 * SECOND, ": keep-alive\n\n"},
+    });
+
+    // one fetch on connect, one for the announcement, none for keep-alives....
+    EXPECT_EQ(run(notifier, 80), (std::vector<uint32_t>{0, 40}));
+    EXPECT_TRUE(notifier.isConnected());
+
+    Shim::HttpRequest request = Shim::MockServer::instance().lastRequest();
+    EXPECT_EQ(request.header("Accept"), "text/event-stream");
+    EXPECT_EQ(request.header("x-api-key"), MockVoyager::API_KEY);
+}
+
+TEST_F(ReleaseNotifierTest, OnlyTheNamedEventCounts) {
+    serveEvents({
+        {10 * SECOND, "event: ping\ndata: x\n\n"},
+        // unnamed events are "message" events....
+        {20 * SECOND, "data: x\n\n"},
+        // named, but no data field....
+        {30 * SECOND, "event: release\n\n"},
+        {40 * SECOND, "event:release\r\ndata: x\r\n\r\n"},
+    });
+
+    EXPECT_EQ(run(notifier, 50), (std::vector<uint32_t>{0, 40}));
+}
+
+TEST_F(ReleaseNotifierTest, EventSplitAcrossPackets) {
+    serveEvents({
+        {10 * SECOND, "event: rel"},
+        {11 * SECOND, "ease\nda"},
+        {12 * SECOND, "ta: 1.1.0\n"},
+        {13 * SECOND, "\n"},
+    });
+
+    EXPECT_EQ(run(notifier, 20), (std::vector<uint32_t>{0, 13}));
+}
+
+TEST_F(ReleaseNotifierTest, DroppedChannelReconnectsBeforePolling) {
+    serveEvents({}, 10 * SECOND);
+
+    // connect, then the reconnect 1 to 1.5 s after the drop....
+    std::vector<uint32_t> fetches = run(notifier, 12);
+    ASSERT_EQ(fetches.size(), 2u);
+    EXPECT_EQ(fetches[0], 0u);
+    EXPECT_EQ(fetches[1], 11u);
+    EXPECT_EQ(Shim::MockServer::instance().stats().requests, 2u);
+
+    // the new channel drops at 21 s, a failed reconnect falls back to
+    // polling in the same poll()....
+    Shim::MockServer::instance().on(EVENTS_PATH, [](const Shim::HttpRequest&) { return Shim::HttpResponse::withStatus(503); });
+    fetches = run(notifier, 12);
+    ASSERT_EQ(fetches.size(), 1u);
+    EXPECT_EQ(fetches[0], 22u);
+}
+
+TEST_F(ReleaseNotifierTest, SilentChannelIsDropped) {
+    notifier.setIdleTimeout(30 * 1000);
+    serveEvents({{10 * SECOND, ": keep-alive\n\n"}});
+
+    run(notifier, 41);
+    EXPECT_FALSE(notifier.isConnected());
+    EXPECT_NE(Shim::takeSerialOutput().find("VOYAGER_OTA Release channel went silent"), std::string::npos);
+}
+
+TEST_F(ReleaseNotifierTest, UnreachableChannelFallsBackToPolling) {
+    Shim::MockServer::instance().on(EVENTS_PATH, [](const Shim::HttpRequest&) { return Shim::HttpResponse::withStatus(503); });
+
+    // the reconnect backoff doubles up to 5 minutes, the poll keeps its 15....
+    std::vector<uint32_t> fetches = run(notifier, 3600, 1000);
+    EXPECT_EQ(fetches, (std::vector<uint32_t>{0, 900, 1800, 2700}));
+    EXPECT_LT(Shim::MockServer::instance().stats().requests, 25u);
+}
+
+TEST_F(ReleaseNotifierTest, StalledServerBlocksPollOnlyForTheConnectTimeout) {
+    Shim::MockServer::instance().on(EVENTS_PATH, [](const Shim::HttpRequest&) {
+        Shim::HttpResponse response = eventStream({});
+        response.latencyMicros = 60 * SECOND;
+        return response;
+    });
+    notifier.setConnectTimeout(1000);
+
+    uint64_t startedAt = Shim::Clock::nowMicros();
+    EXPECT_TRUE(notifier.poll());
+    EXPECT_LE(Shim::Clock::nowMicros() - startedAt, 2 * SECOND);
+    EXPECT_FALSE(notifier.isConnected());
+}
+
+// Requests and bytes one device sends and receives over a simulated day to
+// learn about one release, polling every 15 minutes against holding the
+// event stream, with and without a proxy closing it every hour.
+TEST(ReleaseNotifierBenchmark, PerDevicePerDay) {
+    constexpr uint64_t DAY = 24 * 3600 * SECOND;
+    constexpr uint64_t ANNOUNCED_AT = (13 * 3600 + 7 * 60) * SECOND;
+    // under the 90 s idle timeout of the notifier....
+    constexpr uint64_t KEEP_ALIVE = 60 * SECOND;
+
+    struct Result {
+        const char* name;
+        uint64_t requests;
+        uint64_t fetches;
+        uint64_t bytes;
+        double noticedAfterSeconds;
+    };
+
+    auto simulate = [&](const char* name, bool isStreaming, uint64_t closeAfter) {
+        Shim::reset();
+        MockVoyager::Release release;
+        MockVoyager::serve(release);
+        Shim::MockServer::instance().on(MockVoyager::LATEST_RELEASE_PATH, [release](const Shim::HttpRequest&) {
+            bool isAnnounced = Shim::Clock::nowMicros() >= ANNOUNCED_AT;
+            return isAnnounced ? Shim::HttpResponse::json(200, MockVoyager::releaseJson(release)) : Shim::HttpResponse::json(404, "{\"message\":\"No release\"}");
+        });
+        Shim::MockServer::instance().on(EVENTS_PATH, [closeAfter](const Shim::HttpRequest&) {
+            uint64_t now = Shim::Clock::nowMicros();
+            uint64_t lifetime = std::min(closeAfter, DAY - now);
+            std::vector<Shim::HttpResponse::Push> pushes;
+            for (uint64_t at = KEEP_ALIVE; at < lifetime; at += KEEP_ALIVE) {
+                pushes.push_back({at, ": keep-alive\n\n"});
+            }
+            if (ANNOUNCED_AT > now && ANNOUNCED_AT - now < lifetime) {
+                pushes.push_back({ANNOUNCED_AT - now, "event: release\ndata: {\"version\":\"1.1.0\"}\n\n"});
+                std::stable_sort(pushes.begin(), pushes.end(), [](const auto& a, const auto& b) { return a.afterMicros < b.afterMicros; });
+            }
+            return eventStream(pushes, static_cast<int64_t>(lifetime));
+        });
+
+        Voyager::OTA<> ota("1.0.0");
+        ota.setBaseURL(MockVoyager::BASE_URL);
+        ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+
+        Voyager::ReleaseNotifier notifier;
+        notifier.setPollInterval(15 * 60 * 1000, 0);
+        if (isStreaming) {
+            notifier.setURL(std::string(MockVoyager::BASE_URL).append(EVENTS_PATH).c_str(), {{"x-api-key", MockVoyager::API_KEY}});
+        }
+
+        Result result{name, 0, 0, 0, -1};
+        while (Shim::Clock::nowMicros() < DAY) {
+            if (notifier.poll()) {
+                result.fetches++;
+                if (ota.fetchLatestRelease().has_value() && result.noticedAfterSeconds < 0) {
+                    result.noticedAfterSeconds = static_cast<double>(Shim::Clock::nowMicros() - ANNOUNCED_AT) / SECOND;
+                }
+            }
+            delay(250);
+        }
+        notifier.end();
+
+        Shim::MockServer::Stats stats = Shim::MockServer::instance().stats();
+        result.requests = stats.requests;
+        result.bytes = stats.bytesIn + stats.bytesOut;
+        return result;
+    };
+
+    Result results[] = {
+        simulate("poll 15 min", false, 0),
+        simulate("sse, 1 h proxy", true, 3600 * SECOND),
+        simulate("sse", true, DAY),
+    };
+
+    printf("%-16s %9s %8s %10s %12s\n", "device/day", "requests", "fetches", "bytes", "noticed (s)");
+    for (const Result& result : results) {
+        printf("%-16s %9" PRIu64 " %8" PRIu64 " %10" PRIu64 " %12.1f\n", result.name, result.requests, result.fetches, result.bytes, result.noticedAfterSeconds);
+    }
+
+    // polling needs 96 fetches and learns of the release minutes late, the
+    // stream reconnects once per proxy close and fetches once per reconnect....
+    EXPECT_EQ(results[0].requests, 96u);
+    EXPECT_EQ(results[1].requests, 24u + 24u + 1u);
+    EXPECT_EQ(results[2].requests, 3u);
+    EXPECT_GT(results[0].noticedAfterSeconds, 60.0);
+    EXPECT_LT(results[1].noticedAfterSeconds, 1.0);
+    EXPECT_LT(results[2].noticedAfterSeconds, 1.0);
+    Shim::reset();
+}
@@ -0,0 +1,219 @@
+// Checks the shim behaves like the ESP32 pieces it stands in for, then runs
+// one full check-and-update against the mock Voyager backend.
+#define __ENABLE_DEVELOPMENT_MODE__ true
+
+#include <VoyagerOTA.hpp>
+#include <esp_ota_ops.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <gtest/gtest.h>
+#include <mbedtls/sha256.h>
+#include <atomic>
+#include "MockVoyager.h"
+
+class ShimTest : public ::testing::Test {
+protected:
+    void SetUp() override { Shim::reset(); }
+
+    void TearDown() override { Shim::reset(); }
+};
+
+TEST_F(ShimTest, DelayAdvancesSimulatedClock) {
+    uint32_t startedAt = millis();
+    delay(250);
+    delayMicroseconds(1500);
+
+    EXPECT_EQ(millis() - startedAt, 251u);
+    EXPECT_EQ(Shim::Clock::nowMicros(), 251500u);
+}
+
+TEST_F(ShimTest, PreferencesReadOnlyOpenFailsOnFreshNamespace) {
+    Preferences preferences;
+    EXPECT_FALSE(preferences.begin("voyager", true));
+
+    ASSERT_TRUE(preferences.begin("voyager", false));
+    EXPECT_EQ(preferences.putUInt("count", 3), sizeof(uint32_t));
+    preferences.end();
+
+    ASSERT_TRUE(preferences.begin("voyager", true));
+    EXPECT_EQ(preferences.getUInt("count"), 3u);
+    EXPECT_EQ(preferences.putUInt("count", 4), 0u);
+    preferences.end();
+
+    EXPECT_FALSE(preferences.begin("a-namespace-too-long", false));
+}
+
+TEST_F(ShimTest, FlashWriteWithoutEraseIsCounted) {
+    const esp_partition_t* partition = esp_ota_get_next_update_partition(nullptr);
+    ASSERT_NE(partition, nullptr);
+
+    uint8_t data[32];
+    memset(data, 0x0F, sizeof(data));
+    ASSERT_EQ(esp_partition_erase_range(partition, 0, Shim::Flash::SECTOR_SIZE), ESP_OK);
+    ASSERT_EQ(esp_partition_write(partition, 0, data, sizeof(data)), ESP_OK);
+    EXPECT_EQ(Shim::Flash::stats().unerasedWrites, 0u);
+
+    memset(data, 0xF0, sizeof(data));
+    ASSERT_EQ(esp_partition_write(partition, 0, data, sizeof(data)), ESP_OK);
+    EXPECT_EQ(Shim::Flash::stats().unerasedWrites, 1u);
+    // NOR flash only clears bits....
+    EXPECT_EQ(Shim::Flash::contents(1)[0], 0x00);
+
+    EXPECT_EQ(esp_partition_erase_range(partition, 100, Shim::Flash::SECTOR_SIZE), ESP_ERR_INVALID_ARG);
+}
+
+TEST_F(ShimTest, EncryptedFlashRejectsUnalignedWrites) {
+    Shim::Flash::Config config;
+    config.isEncrypted = true;
+    Shim::Flash::configure(config);
+
+    const esp_partition_t* partition = esp_ota_get_next_update_partition(nullptr);
+    uint8_t data[32] = {};
+    ASSERT_EQ(esp_partition_erase_range(partition, 0, Shim::Flash::SECTOR_SIZE), ESP_OK);
+
+    EXPECT_EQ(esp_partition_write(partition, 0, data, 20), ESP_ERR_INVALID_SIZE);
+    EXPECT_EQ(esp_partition_write(partition, 8, data, 16), ESP_ERR_INVALID_SIZE);
+    EXPECT_EQ(esp_partition_write(partition, 16, data, 32), ESP_OK);
+    EXPECT_EQ(Shim::Flash::stats().rejectedWrites, 2u);
+}
+
+TEST_F(ShimTest, BootloaderAbortsUnconfirmedImage) {
+    Shim::Flash::Config config;
+    config.isRollbackEnabled = true;
+    Shim::Flash::configure(config);
+    Shim::esp().throwOnRestart = false;
+
+    Shim::Flash::install(1, Shim::makeFirmwareImage(64 * 1024, 2));
+    ASSERT_EQ(esp_ota_set_boot_partition(esp_ota_get_next_update_partition(nullptr)), ESP_OK);
+
+    ESP.restart();
+    ASSERT_EQ(Shim::Boot::runningSlot(), 1);
+    esp_ota_img_states_t state;
+    ASSERT_EQ(esp_ota_get_state_partition(esp_ota_get_running_partition(), &state), ESP_OK);
+    EXPECT_EQ(state, ESP_OTA_IMG_PENDING_VERIFY);
+
+    // crashed before confirming the image....
+    ESP.restart();
+    EXPECT_EQ(Shim::Boot::runningSlot(), 0);
+    EXPECT_EQ(Shim::restartCount(), 2);
+}
+
+TEST_F(ShimTest, HttpClientFollowsRedirectsAndReportsSize) {
+    Shim::MockServer& server = Shim::MockServer::instance();
+    server.on("/old", [](const Shim::HttpRequest&) {
+        return Shim::HttpResponse::withStatus(302).header("Location", "https://cdn.test/new");
+    });
+    server.on("/new", [](const Shim::HttpRequest& request) {
+        return Shim::HttpResponse::json(200, "{\"query\":\"" + request.query + "\"}");
+    });
+
+    HTTPClient client;
+    ASSERT_TRUE(client.begin("https://voyager.test/old?a=1"));
+    client.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+    EXPECT_EQ(client.GET(), 200);
+    EXPECT_EQ(client.getString(), "{\"query\":\"\"}");
+    client.end();
+
+    ASSERT_TRUE(client.begin("https://voyager.test/new"));
+    EXPECT_EQ(client.sendRequest("HEAD"), 200);
+    EXPECT_EQ(client.getSize(), 12);
+    EXPECT_EQ(client.getString(), "");
+    client.end();
+
+    EXPECT_FALSE(client.begin("voyager.test/new"));
+    EXPECT_EQ(server.stats().requests, 3u);
+}
+
+TEST_F(ShimTest, HttpBodyArrivesAtConfiguredRate) {
+    Shim::MockServer::instance().on("/blob", [](const Shim::HttpRequest&) {
+        Shim::HttpResponse response = Shim::HttpResponse::binary(std::string(100 * 1000, 'x'));
+        response.bytesPerSecond = 10 * 1000;
+        return response;
+    });
+
+    HTTPClient client;
+    ASSERT_TRUE(client.begin("https://voyager.test/blob"));
+    ASSERT_EQ(client.GET(), 200);
+
+    uint64_t startedAt = Shim::Clock::nowMicros();
+    String body = client.getString();
+    uint64_t elapsedMs = (Shim::Clock::nowMicros() - startedAt) / 1000;
+
+    EXPECT_EQ(body.length(), 100u * 1000);
+    EXPECT_NEAR(static_cast<double>(elapsedMs), 10000.0, 50.0);
+}
+
+TEST_F(ShimTest, UnreachableServerRefusesConnection) {
+    Shim::MockServer::instance().setReachable(false);
+
+    HTTPClient client;
+    ASSERT_TRUE(client.begin("https://voyager.test/anything"));
+    EXPECT_EQ(client.GET(), HTTPC_ERROR_CONNECTION_REFUSED);
+}
+
+TEST_F(ShimTest, QueueKeepsFrontAndBackOrder) {
+    QueueHandle_t queue = xQueueCreate(3, sizeof(int));
+    int values[] = {1, 2, 3};
+    ASSERT_EQ(xQueueSendToBack(queue, &values[0], 0), pdPASS);
+    ASSERT_EQ(xQueueSendToBack(queue, &values[1], 0), pdPASS);
+    ASSERT_EQ(xQueueSendToFront(queue, &values[2], 0), pdPASS);
+    EXPECT_EQ(xQueueSendToBack(queue, &values[0], 0), pdFAIL);
+
+    int received = 0;
+    std::vector<int> order;
+    while (xQueueReceive(queue, &received, 0) == pdPASS) {
+        order.push_back(received);
+    }
+    EXPECT_EQ(order, (std::vector<int>{3, 1, 2}));
+    vQueueDelete(queue);
+}
+
+TEST_F(ShimTest, TaskRunsUntilItDeletesItself) {
+    static std::atomic<int> runs{0};
+    auto task = [](void*) {
+        runs++;
+        vTaskDelete(nullptr);
+        runs++;
+    };
+
+    ASSERT_EQ(xTaskCreatePinnedToCore(task, "task", 4096, nullptr, 1, nullptr, 0), pdPASS);
+    Shim::Tasks::joinAll();
+    EXPECT_EQ(runs.load(), 1);
+    EXPECT_EQ(Shim::Tasks::count(), 0u);
+}
+
+TEST_F(ShimTest, DigestsMatchKnownVectors) {
+    mbedtls_sha256_context context;
+    unsigned char digest[32];
+    mbedtls_sha256_init(&context);
+    mbedtls_sha256_starts(&context, 0);
+    mbedtls_sha256_update(&context, reinterpret_cast<const unsigned char*>("abc"), 3);
+    mbedtls_sha256_finish(&context, digest);
+    mbedtls_sha256_free(&context);
+
+    EXPECT_EQ(Shim::toHex(digest, sizeof(digest)), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    EXPECT_EQ(Shim::md5Hex({}), "d41d8cd98f00b204e9800998ecf8427e");
+}
+
+TEST_F(ShimTest, ChecksAndInstallsRelease) {
+    MockVoyager::Release release;
+    MockVoyager::serve(release);
+
+    Voyager::OTA<> ota("1.0.0");
+    ota.setBaseURL(MockVoyager::BASE_URL);
+    ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+
+    auto latest = ota.fetchLatestRelease();
+    ASSERT_TRUE(latest.has_value());
+    EXPECT_EQ(latest->version, "1.1.0");
+    EXPECT_EQ(latest->size, static_cast<int>(release.image.size()));
+    EXPECT_EQ(Shim::MockServer::instance().lastRequest().query, "channel=staging");
+    ASSERT_TRUE(ota.isNewVersion(latest->version));
+
+    ota.setDownloadURL(latest->downloadURL);
+    EXPECT_THROW(ota.performUpdate(), Shim::Restart);
+
+    EXPECT_EQ(Shim::Boot::runningSlot(), 1);
+    std::vector<uint8_t>& flashed = Shim::Flash::contents(1);
+    EXPECT_TRUE(std::equal(release.image.begin(), release.image.end(), flashed.begin()));
+}
@@ -0,0 +1,295 @@
+// SignatureVerifier against OpenSSL produced signatures: a fixed vector made
+// with the command from the class comment, tampered images and signatures,
+// the x-signature path of performUpdate(), and hashing throughput.
+#define __ENABLE_DEVELOPMENT_MODE__ true
+
+#include <VoyagerOTA.hpp>
+#include <gtest/gtest.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MockVoyager.h"
+
+namespace {
+    // openssl ecparam -name prime256v1 -genkey -noout -out private.pem
+    // openssl ec -in private.pem -pubout
+    constexpr const char* EC_PUBLIC_KEY =
+        "-----BEGIN PUBLIC KEY-----\n"
+        "MFkwEwYHKoZIzj0CAQYIKoZIzj0DAQcDQgAEAc+OR9hr7ca34FWR+zRcS3Qfgv5D\n"
+        "QJNATaTe8NQhpbrro/+eSrQWqB5Jwx9l2U2N8IW23xTEzPPKC1yYAlQsZw==\n"
+        "-----END PUBLIC KEY-----\n";
+
+    // openssl dgst -sha256 -sign private.pem firmware.bin | base64 -w0, where
+    // firmware.bin is Shim::makeFirmwareImage(4096, 1)....
+    constexpr const char* EC_SIGNATURE =
+        "MEUCIQCsDEX0B8x/4hGZ/sorhLdjVAOF/pER01GIkAulteNXXgIgNcFlsnmP25bceNnqFe6zocwIAhpqYO+2DnPRr4zBqaU=";
+
+    // openssl genrsa 2048 | openssl rsa -pubout, same image....
+    constexpr const char* RSA_PUBLIC_KEY =
+        "-----BEGIN PUBLIC KEY-----\n"
+        "MIIBIjANBgkqhkiG9w0BAQEFAAOCAQ8AMIIBCgKCAQEAxWcD1yp72NnLNsdxEGSq\n"
+        "WbqChGriVBoH9P+0PUj0w2t02Mb8M/EoLKoe6kX/DA+W9GSM9VCj5uW8ibZL50+W\n"
+        "9Z5ePkwz+qBqEcsgWmGyQECAjaTrzXx0FDVKAuCMxSIzVcq1DAhtjeD3/T7qd5i+\n"
+        "m3akSoUgf58I/3GzC59tVZW+d+h+/MqXqbG7ZO+QoVOfpCtCn4jWZemmYUX7spSG\n"
+        "Tij8988/vjzH0yLu0NjgfhOUaTYp6ofgdnrlAgT+UnyQshJhrY+Z4ZP+hFnpaTa6\n"
+        "dAJeXiLwGdxWqyFq0dqoxUES+yvgyRehqE3MUzT6bw7JealXf5VpEPI/ucodzj0w\n"
+        "VQIDAQAB\n"
+        "-----END PUBLIC KEY-----\n";
+
+    constexpr const char* RSA_SIGNATURE =
+        "GkfKE6fi4POCwv/SqKAy+yt3FGV2eIx4WOe3Y3ujJKyq4xCm0Y0tMn6A8EMWs9mGvjqK9nuTdU2+yw8luEyNWFt7MrlGfpJxiU/uwgzN0C3dNyIzNr8MOGt/"
+        "gSw1OK3sl3uLEmjKWR8UKDxXwNjTYie6H3To/FTMHGlVGJGEFCNiUxtnHWEWwPtNN1BIgeWgaVw+BNHVRVh6x91KHv+eCv7/aPNyptT9e9+UVa7982STFG6K"
+        "xusgNtdYIHmu+G2ZJg6DpYBMxuIENtIUO54jxg7d7YMs69Viuqezn0oHeYjrdsbobjdCoZKHvKAxDBQft6Wk7PDN/pifGJq/czS8fA==";
+
+    bool verify(Voyager::SignatureVerifier& verifier, const std::vector<uint8_t>& image, const String& signature, size_t chunk = 1024) {
+        if (!verifier.begin()) {
+            return false;
+        }
+        for (size_t offset = 0; offset < image.size(); offset += chunk) {
+            verifier.update(image.data() + offset, std::min(chunk, image.size() - offset));
+        }
+        return verifier.verify(signature);
+    }
+
+    // A fresh P-256 key pair, for signing images the tests make up.
+    class SigningKey {
+    public:
+        SigningKey() {
+            EVP_PKEY_CTX* context = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+            EVP_PKEY_keygen_init(context);
+            EVP_PKEY_CTX_set_ec_paramgen_curve_nid(context, NID_X9_62_prime256v1);
+            EVP_PKEY_keygen(context, &_key);
+            EVP_PKEY_CTX_free(context);
+
+            BIO* bio = BIO_new(BIO_s_mem());
+            PEM_write_bio_PUBKEY(bio, _key);
+            char* pem = nullptr;
+            long length = BIO_get_mem_data(bio, &pem);
+            _publicKeyPEM.assign(pem, static_cast<size_t>(length));
+            BIO_free(bio);
+        }
+
+        ~SigningKey() { EVP_PKEY_free(_key); }
+
+        const char* publicKeyPEM() const { return _publicKeyPEM.c_str(); }
+
+        std::string sign(const std::vector<uint8_t>& image) const {
+            EVP_MD_CTX* context = EVP_MD_CTX_new();
+            size_t length = 0;
+            EVP_DigestSignInit(context, nullptr, EVP_sha256(), nullptr, _key);
+            EVP_DigestSign(context, nullptr, &length, image.data(), image.size());
+            std::vector<uint8_t> signature(length);
+            EVP_DigestSign(context, signature.data(), &length, image.data(), image.size());
+            EVP_MD_CTX_free(context);
+
+            std::string base64(4 * ((length + 2) / 3) + 1, '\0');
+            int written = EVP_EncodeBlock(reinterpret_cast<unsigned char*>(&base64[0]), signature.data(), static_cast<int>(length));
+            base64.resize(static_cast<size_t>(written));
+            return base64;
+        }
+
+    private:
+        EVP_PKEY* _key = nullptr;
+        std::string _publicKeyPEM;
+    };
+
+    std::string flipCharacter(std::string base64, size_t index) {
+        base64[index] = base64[index] == 'A' ? 'B' : 'A';
+        return base64;
+    }
+}  // namespace
+
+class SignatureVerifierTest : public ::testing::Test {
+protected:
+    void SetUp() override { Shim::reset(); }
+
+    void TearDown() override { Shim::reset(); }
+
+    std::vector<uint8_t> image = Shim::makeFirmwareImage(4096, 1);
+};
+
+TEST_F(SignatureVerifierTest, MbedtlsVersion) {
+    // SignatureVerifierMbedtls2Test builds this file against the mbedtls 2.x
+    // headers of arduino-esp32 2.x....
+    printf("mbedtls %d API\n", MBEDTLS_VERSION_MAJOR);
+    EXPECT_TRUE(MBEDTLS_VERSION_MAJOR == 2 || MBEDTLS_VERSION_MAJOR == 3);
+}
+
+TEST_F(SignatureVerifierTest, OpenSSLVectorsVerify) {
+    Voyager::SignatureVerifier ec(EC_PUBLIC_KEY);
+    EXPECT_TRUE(verify(ec, image, EC_SIGNATURE));
+
+    Voyager::SignatureVerifier rsa(RSA_PUBLIC_KEY);
+    EXPECT_TRUE(verify(rsa, image, RSA_SIGNATURE));
+}
+
+TEST_F(SignatureVerifierTest, ChunkSizeDoesNotMatter) {
+    Voyager::SignatureVerifier verifier(EC_PUBLIC_KEY);
+    for (size_t chunk : {1u, 7u, 512u, 4095u, 4096u, 65536u}) {
+        EXPECT_TRUE(verify(verifier, image, EC_SIGNATURE, chunk)) << chunk;
+    }
+}
+
+TEST_F(SignatureVerifierTest, TamperedImageIsRejected) {
+    Voyager::SignatureVerifier verifier(EC_PUBLIC_KEY);
+
+    for (size_t index : {size_t(0), image.size() / 2, image.size() - 1}) {
+        std::vector<uint8_t> tampered = image;
+        tampered[index] ^= 0x01;
+        EXPECT_FALSE(verify(verifier, tampered, EC_SIGNATURE)) << index;
+    }
+
+    std::vector<uint8_t> truncated(image.begin(), image.end() - 1);
+    EXPECT_FALSE(verify(verifier, truncated, EC_SIGNATURE));
+
+    std::vector<uint8_t> extended = image;
+    extended.push_back(0xFF);
+    EXPECT_FALSE(verify(verifier, extended, EC_SIGNATURE));
+
+    // and the verifier is still good for the genuine image....
+    EXPECT_TRUE(verify(verifier, image, EC_SIGNATURE));
+}
+
+TEST_F(SignatureVerifierTest, TamperedSignatureIsRejected) {
+    Voyager::SignatureVerifier verifier(EC_PUBLIC_KEY);
+    std::string signature = EC_SIGNATURE;
+
+    EXPECT_FALSE(verify(verifier, image, String(flipCharacter(signature, 10))));
+    EXPECT_FALSE(verify(verifier, image, String(flipCharacter(signature, signature.size() - 5))));
+    EXPECT_FALSE(verify(verifier, image, String(signature.substr(0, signature.size() - 4))));
+    EXPECT_FALSE(verify(verifier, image, String("not*base64!")));
+    EXPECT_FALSE(verify(verifier, image, String("")));
+
+    // the RSA signature of the same image under the EC key....
+    EXPECT_FALSE(verify(verifier, image, RSA_SIGNATURE));
+}
+
+TEST_F(SignatureVerifierTest, WrongKeyIsRejected) {
+    SigningKey otherKey;
+    Voyager::SignatureVerifier verifier(otherKey.publicKeyPEM());
+    EXPECT_FALSE(verify(verifier, image, EC_SIGNATURE));
+    EXPECT_TRUE(verify(verifier, image, String(otherKey.sign(image))));
+}
+
+TEST_F(SignatureVerifierTest, BadKeyFailsBegin) {
+    Voyager::SignatureVerifier verifier("-----BEGIN PUBLIC KEY-----\nAAAA\n-----END PUBLIC KEY-----\n");
+    EXPECT_FALSE(verifier.begin());
+    EXPECT_FALSE(verifier.verify(EC_SIGNATURE));
+}
+
+TEST_F(SignatureVerifierTest, VerifyWithoutBeginFails) {
+    Voyager::SignatureVerifier verifier(EC_PUBLIC_KEY);
+    ASSERT_TRUE(verify(verifier, image, EC_SIGNATURE));
+
+    // a finished digest is not verified twice....
+    EXPECT_FALSE(verifier.verify(EC_SIGNATURE));
+}
+
+class SignedUpdateTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Shim::reset();
+        Shim::esp().throwOnRestart = false;
+
+        ota.setBaseURL(MockVoyager::BASE_URL);
+        ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+        ota.setSignatureVerifier(verifier);
+        ota.attachEventCallbacks([] {}, [](int, int) {}, [] {}, [this](int code) { errorCode = code; });
+    }
+
+    void TearDown() override { Shim::reset(); }
+
+    void performUpdate() {
+        MockVoyager::serve(release);
+        ota.setDownloadURL(release.downloadURL());
+        ota.performUpdate();
+    }
+
+    SigningKey key;
+    Voyager::SignatureVerifier verifier{key.publicKeyPEM()};
+    MockVoyager::Release release;
+    Voyager::OTA<> ota{"1.0.0"};
+    int errorCode = 0;
+};
+
+TEST_F(SignedUpdateTest, SignedImageInstalls) {
+    release.signature = key.sign(release.image);
+    performUpdate();
+
+    EXPECT_EQ(errorCode, 0);
+    EXPECT_EQ(ota.getLastUpdateResult(), HTTP_UPDATE_OK);
+    EXPECT_EQ(Shim::Boot::bootSlot(), 1);
+}
+
+TEST_F(SignedUpdateTest, TamperedImageIsNotBooted) {
+    release.signature = key.sign(release.image);
+    release.image[release.image.size() / 2] ^= 0x80;
+    performUpdate();
+
+    EXPECT_EQ(errorCode, Voyager::UpdateError::SIGNATURE_INVALID);
+    EXPECT_EQ(ota.getLastUpdateResult(), HTTP_UPDATE_FAILED);
+    EXPECT_EQ(Shim::Boot::bootSlot(), 0);
+}
+
+TEST_F(SignedUpdateTest, TamperedSignatureIsNotBooted) {
+    release.signature = flipCharacter(key.sign(release.image), 12);
+    performUpdate();
+
+    EXPECT_EQ(errorCode, Voyager::UpdateError::SIGNATURE_INVALID);
+    EXPECT_EQ(Shim::Boot::bootSlot(), 0);
+}
+
+TEST_F(SignedUpdateTest, MissingSignatureIsNotWritten) {
+    performUpdate();
+
+    EXPECT_EQ(errorCode, Voyager::UpdateError::SIGNATURE_MISSING);
+    EXPECT_EQ(Shim::Boot::bootSlot(), 0);
+    EXPECT_EQ(Shim::Flash::stats().bytesWritten, 0u);
+}
+
+TEST_F(SignedUpdateTest, ExplicitSignatureWinsOverHeader) {
+    release.signature = flipCharacter(key.sign(release.image), 12);
+    ota.setSignature(String(key.sign(release.image)));
+    performUpdate();
+
+    EXPECT_EQ(errorCode, 0);
+    EXPECT_EQ(Shim::Boot::bootSlot(), 1);
+}
+
+// SHA-256 throughput of update() at the chunk sizes of the download loop,
+// and the one-off cost of verify(). Host numbers, the ESP32 hashes in its
+// SHA accelerator.
+TEST(SignatureVerifierBenchmark, Throughput) {
+    constexpr size_t IMAGE_SIZE = 16 * 1024 * 1024;
+    constexpr int VERIFICATIONS = 200;
+
+    Shim::reset();
+    std::vector<uint8_t> image = Shim::makeFirmwareImage(IMAGE_SIZE, 3);
+    Voyager::SignatureVerifier verifier(EC_PUBLIC_KEY);
+
+    printf("%-10s %10s\n", "chunk B", "MB/s");
+    for (size_t chunk : {256u, 1024u, 4096u}) {
+        ASSERT_TRUE(verifier.begin());
+        auto startedAt = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset < image.size(); offset += chunk) {
+            verifier.update(image.data() + offset, chunk);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startedAt).count();
+        EXPECT_FALSE(verifier.verify(EC_SIGNATURE));
+        printf("%-10zu %10.1f\n", chunk, IMAGE_SIZE / seconds / (1024 * 1024));
+    }
+
+    std::vector<uint8_t> vector = Shim::makeFirmwareImage(4096, 1);
+    auto startedAt = std::chrono::steady_clock::now();
+    for (int i = 0; i < VERIFICATIONS; i++) {
+        ASSERT_TRUE(verify(verifier, vector, EC_SIGNATURE, vector.size()));
+    }
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startedAt).count();
+    printf("verify(): %.0f us, P-256, 4 KB image\n", micros / VERIFICATIONS);
+    Shim::reset();
+}
@@ -0,0 +1,142 @@
+// StaticOTA with the non-virtual parsers, and the cost per call of parsing
+// through IParser against calling the parser directly.
+#define __ENABLE_DEVELOPMENT_MODE__ true
+
+#include <VoyagerOTA.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include "MockVoyager.h"
+
+using Voyager::VoyagerReleaseModel;
+
+static_assert(!std::is_polymorphic_v<Voyager::StaticVoyagerJSONParser>);
+static_assert(!std::is_polymorphic_v<Voyager::StaticVoyagerMsgPackParser>);
+static_assert(!std::is_polymorphic_v<Voyager::StaticOTA<Voyager::StaticVoyagerJSONParser>>);
+static_assert(std::is_same_v<Voyager::StaticOTA<Voyager::StaticVoyagerJSONParser>::Parser, Voyager::StaticVoyagerJSONParser>);
+static_assert(std::is_polymorphic_v<Voyager::OTA<>>);
+
+class StaticParserTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Shim::reset();
+        MockVoyager::serve(release);
+    }
+
+    void TearDown() override { Shim::reset(); }
+
+    template <typename T_OTA>
+    std::optional<VoyagerReleaseModel> fetch(T_OTA& ota) {
+        ota.setBaseURL(MockVoyager::BASE_URL);
+        ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+        return ota.fetchLatestRelease();
+    }
+
+    MockVoyager::Release release;
+};
+
+TEST_F(StaticParserTest, JsonParserFetchesRelease) {
+    Voyager::StaticOTA<Voyager::StaticVoyagerJSONParser> ota("1.0.0");
+    std::optional<VoyagerReleaseModel> payload = fetch(ota);
+
+    ASSERT_TRUE(payload.has_value());
+    EXPECT_EQ(payload->version, String("1.1.0"));
+    EXPECT_EQ(payload->size, static_cast<int>(release.image.size()));
+    EXPECT_FALSE(Shim::MockServer::instance().lastRequest().hasHeader("Accept"));
+}
+
+TEST_F(StaticParserTest, MsgPackParserNegotiates) {
+    Voyager::StaticOTA<Voyager::StaticVoyagerMsgPackParser> ota("1.0.0");
+    std::optional<VoyagerReleaseModel> payload = fetch(ota);
+
+    ASSERT_TRUE(payload.has_value());
+    EXPECT_EQ(payload->hash, String(Shim::md5Hex(release.image)));
+    EXPECT_EQ(Shim::MockServer::instance().lastRequest().header("Accept"), "application/msgpack, application/json;q=0.5");
+}
+
+TEST_F(StaticParserTest, CustomModelWithoutParserIsNotFetched) {
+    struct CustomModel : public Voyager::BaseModel {
+        using BaseModel::BaseModel;
+    };
+
+    Voyager::OTA<Voyager::HTTPResponseData, CustomModel> ota("1.0.0");
+    ota.setBaseURL(MockVoyager::BASE_URL);
+    ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+
+    EXPECT_FALSE(ota.fetchLatestRelease().has_value());
+    EXPECT_EQ(Shim::MockServer::instance().stats().requests, 0u);
+    EXPECT_NE(Shim::takeSerialOutput().find("Parser is required!"), std::string::npos);
+}
+
+TEST_F(StaticParserTest, DynamicParsersForwardToStaticOnes) {
+    String json(MockVoyager::releaseJson(release));
+    std::optional<VoyagerReleaseModel> direct = Voyager::StaticVoyagerJSONParser().parse(json, 200);
+    std::optional<VoyagerReleaseModel> forwarded = Voyager::VoyagerJSONParser().parse(json, 200);
+    ASSERT_TRUE(direct && forwarded);
+    EXPECT_EQ(direct->downloadURL, forwarded->downloadURL);
+
+    EXPECT_FALSE(Voyager::VoyagerJSONParser().parse(String("{\"message\":\"gone\"}"), 404).has_value());
+    EXPECT_STREQ(Voyager::VoyagerMsgPackParser().acceptType(), Voyager::StaticVoyagerMsgPackParser().acceptType());
+}
+
+namespace {
+    // Returns a prepared model, so only the call itself is measured.
+    struct CachedParser {
+        std::optional<VoyagerReleaseModel> parse(const Voyager::HTTPResponseData&, int) const { return model; }
+
+        std::optional<VoyagerReleaseModel> model;
+    };
+
+    struct VirtualCachedParser final : public Voyager::IParser<> {
+        std::optional<VoyagerReleaseModel> parse(Voyager::HTTPResponseData responseData, int statusCode) override { return cached.parse(responseData, statusCode); }
+
+        CachedParser cached;
+    };
+
+    // Read through a volatile pointer so the compiler can not devirtualize....
+    Voyager::IParser<>* volatile virtualParser = nullptr;
+
+    template <typename T_Call>
+    double nanosPerCall(int iterations, T_Call call) {
+        volatile int sizes = 0;
+        auto startedAt = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            sizes = sizes + call()->size;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - startedAt;
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / iterations;
+    }
+}  // namespace
+
+// The parse itself dominates, the dispatch only shows with a parser that
+// does no work. Both ways are measured and printed only, the timings are
+// too noisy to assert on; that the static parsers carry no vtable is
+// checked by the static_asserts at the top.
+TEST(StaticParserBenchmark, DirectAgainstVirtualCall) {
+#if VOYAGER_ARDUINOJSON_STANDIN
+    GTEST_SKIP() << "built against the ArduinoJson stand-in";
+#endif
+    Shim::reset();
+    MockVoyager::Release release;
+    const String json(MockVoyager::releaseJson(release));
+
+    Voyager::StaticVoyagerJSONParser staticParser;
+    Voyager::VoyagerJSONParser dynamicParser;
+    virtualParser = &dynamicParser;
+    double staticParse = nanosPerCall(20000, [&] { return staticParser.parse(json, 200); });
+    double virtualParse = nanosPerCall(20000, [&] { return virtualParser->parse(json, 200); });
+
+    CachedParser cachedParser{Voyager::StaticVoyagerJSONParser().parse(json, 200)};
+    VirtualCachedParser virtualCachedParser;
+    virtualCachedParser.cached = cachedParser;
+    virtualParser = &virtualCachedParser;
+    double staticCall = nanosPerCall(2000000, [&] { return cachedParser.parse(json, 200); });
+    double virtualCall = nanosPerCall(2000000, [&] { return virtualParser->parse(json, 200); });
+
+    printf("%-24s %12s %12s\n", "ns/call", "direct", "IParser");
+    printf("%-24s %12.1f %12.1f\n", "parse release JSON", staticParse, virtualParse);
+    // IParser takes the response by value, one String copy per call on top
+    // of the indirect call....
+    printf("%-24s %12.1f %12.1f\n", "return cached model", staticCall, virtualCall);
+    Shim::reset();
+}
@@ -0,0 +1,52 @@
+# Compares the dynamic and static parser builds of ParserFootprint.cpp:
+# the static one must carry no parser or OTA vtable, and both sizes are
+# printed. Host sizes only show the direction, the ESP32 numbers come from
+# tools/size_report.py.
+#
+#   cmake -DNM=nm -DSIZE=size -DDYNAMIC=<binary> -DSTATIC=<binary> -P CheckParserFootprint.cmake
+
+function(voyager_vtables binary result)
+  execute_process(COMMAND ${NM} -C ${binary} OUTPUT_VARIABLE symbols RESULT_VARIABLE status)
+  if(NOT status EQUAL 0)
+    message(FATAL_ERROR "nm failed on ${binary}")
+  endif()
+  string(REGEX MATCHALL "vtable for Voyager::[^\n]*" vtables "${symbols}")
+  set(${result} "${vtables}" PARENT_SCOPE)
+endfunction()
+
+function(voyager_text_size binary result)
+  execute_process(COMMAND ${SIZE} ${binary} OUTPUT_VARIABLE output)
+  string(REGEX MATCH "\n[ \t]*([0-9]+)" line "${output}")
+  set(${result} ${CMAKE_MATCH_1} PARENT_SCOPE)
+endfunction()
+
+foreach(binary DYNAMIC STATIC)
+  execute_process(COMMAND ${${binary}} RESULT_VARIABLE status)
+  if(NOT status EQUAL 0)
+    message(FATAL_ERROR "${${binary}} did not complete an update")
+  endif()
+endforeach()
+
+voyager_vtables(${DYNAMIC} dynamicVtables)
+voyager_vtables(${STATIC} staticVtables)
+voyager_text_size(${DYNAMIC} dynamicText)
+voyager_text_size(${STATIC} staticText)
+math(EXPR savedText "${dynamicText} - ${staticText}")
+
+message(STATUS "dynamic OTA<>: .text ${dynamicText} bytes, ${dynamicVtables}")
+message(STATUS "StaticOTA<StaticVoyagerJSONParser>: .text ${staticText} bytes, ${staticVtables}")
+message(STATUS "saved: ${savedText} bytes of .text")
+
+# the check has to see the vtables it looks for....
+if(NOT dynamicVtables MATCHES "Parser" OR NOT dynamicVtables MATCHES "OTA<")
+  message(FATAL_ERROR "no parser vtable found in the dynamic build, the check is broken")
+endif()
+
+# BaseModel keeps its virtual destructor, so the model vtable stays....
+if(staticVtables MATCHES "Parser" OR staticVtables MATCHES "OTA")
+  message(FATAL_ERROR "the static build still links parser vtables: ${staticVtables}")
+endif()
+
+if(savedText LESS_EQUAL 0)
+  message(FATAL_ERROR "the static build is not smaller than the dynamic one")
+endif()
@@ -0,0 +1,126 @@
+// Host equivalents of the examples, built once per example (VoyagerOTA by
+// default, VOYAGER_FOOTPRINT_GITHUB or VOYAGER_FOOTPRINT_CUSTOM), linked with
+// section garbage collection. Each runs the example's check-and-update against
+// the mock server and prints its heap use as JSON, which tools/size_report.py
+// --host-build adds to the report next to the section and symbol sizes.
+#if VOYAGER_FOOTPRINT_GITHUB || VOYAGER_FOOTPRINT_CUSTOM
+  #define __ENABLE_ADVANCED_MODE__ true
+#else
+  #define __ENABLE_DEVELOPMENT_MODE__ true
+#endif
+
+#include <VoyagerOTA.hpp>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include "HeapTracker.h"
+#include "MockVoyager.h"
+
+#if VOYAGER_FOOTPRINT_GITHUB || VOYAGER_FOOTPRINT_CUSTOM
+namespace {
+    constexpr const char* RELEASE_PATH = "/repos/owner/repo/releases/latest";
+
+    // The advanced mode examples talk to their own backend, without the
+    // Voyager credentials....
+    void serveAdvanced(const MockVoyager::Release& release, const std::string& document) {
+        Shim::MockServer& server = Shim::MockServer::instance();
+        server.on(RELEASE_PATH, [document](const Shim::HttpRequest&) { return Shim::HttpResponse::json(200, document); });
+        server.on(release.downloadPath(), [release](const Shim::HttpRequest&) {
+            return Shim::HttpResponse::binary(std::string(release.image.begin(), release.image.end()));
+        });
+    }
+}  // namespace
+#endif
+
+#if VOYAGER_FOOTPRINT_CUSTOM
+struct CustomModel : public Voyager::BaseModel {
+    String description;
+    int statusCode;
+
+    explicit CustomModel(String version, String description, String downloadURL, int statusCode)
+        : BaseModel(version, downloadURL), description(description), statusCode(statusCode) {}
+};
+
+class CustomParser : public Voyager::IParser<Voyager::HTTPResponseData, CustomModel> {
+public:
+    std::optional<CustomModel> parse(Voyager::HTTPResponseData responseData, int statusCode) override {
+        ArduinoJson::JsonDocument document;
+        if (ArduinoJson::deserializeJson(document, responseData) || statusCode != HTTP_CODE_OK) {
+            return std::nullopt;
+        }
+        return CustomModel(document["version"], document["description"], document["downloadUrl"], statusCode);
+    }
+};
+#endif
+
+// Mirrors setup() of the example, returns the update result.
+int checkAndUpdate(const MockVoyager::Release& release) {
+#if VOYAGER_FOOTPRINT_GITHUB
+    Voyager::OTA<Voyager::HTTPResponseData, Voyager::GithubReleaseModel> ota("1.0.0", std::make_unique<Voyager::GithubJSONParser>());
+    std::vector<Voyager::Header> releaseHeaders = {
+        {"Authorization", "Bearer token"},
+        {"X-GitHub-Api-Version", "2022-11-28"},
+        {"Accept", "application/vnd.github+json"},
+    };
+    ota.setReleaseURL((std::string(MockVoyager::BASE_URL) + RELEASE_PATH).c_str(), releaseHeaders);
+    std::vector<Voyager::Header> downloadHeaders = {
+        {"Authorization", "Bearer token"},
+        {"X-GitHub-Api-Version", "2022-11-28"},
+        {"Accept", "application/octet-stream"},
+    };
+#elif VOYAGER_FOOTPRINT_CUSTOM
+    Voyager::OTA<Voyager::HTTPResponseData, CustomModel> ota("1.0.0", std::make_unique<CustomParser>());
+    ota.setReleaseURL((std::string(MockVoyager::BASE_URL) + RELEASE_PATH).c_str());
+    std::vector<Voyager::Header> downloadHeaders;
+#else
+    Voyager::OTA<> ota("1.0.0");
+    ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+    ota.setBaseURL(MockVoyager::BASE_URL);
+    std::vector<Voyager::Header> downloadHeaders;
+#endif
+
+    auto payload = ota.fetchLatestRelease();
+    if (!payload || !ota.isNewVersion(payload->version)) {
+        return -1;
+    }
+
+    ota.setDownloadURL(payload->downloadURL, downloadHeaders);
+    ota.performUpdate();
+    return ota.getLastUpdateResult();
+}
+
+int main() {
+    Shim::reset();
+    Shim::esp().throwOnRestart = false;
+    MockVoyager::Release release;
+
+#if VOYAGER_FOOTPRINT_GITHUB
+    const char* name = "GithubOTA";
+    serveAdvanced(release,
+                  "{\"tag_name\":\"" + release.version + "\",\"name\":\"Release " + release.version +
+                      "\",\"published_at\":\"2026-10-01T10:00:00Z\",\"assets\":[{\"url\":\"" + release.downloadURL() +
+                      "\",\"size\":" + std::to_string(release.image.size()) + "}]}");
+#elif VOYAGER_FOOTPRINT_CUSTOM
+    const char* name = "CustomOTA";
+    serveAdvanced(release,
+                  "{\"version\":\"" + release.version + "\",\"description\":\"Bug fixes\",\"downloadUrl\":\"" + release.downloadURL() + "\"}");
+#else
+    const char* name = "VoyagerOTA";
+    MockVoyager::serve(release);
+#endif
+
+    // from construction of the client to the reboot into the new image....
+    HeapTracker::reset();
+    int result = checkAndUpdate(release);
+    HeapTracker::Stats heap = HeapTracker::stats();
+
+    bool isUpdated = result == HTTP_UPDATE_OK && Shim::Boot::bootSlot() == 1;
+    printf("{\"name\": \"%s\", \"updated\": %s, \"peak_heap\": %" PRId64 ", \"allocations\": %" PRIu64 ", \"allocated_bytes\": %" PRIu64 ", \"leaked_bytes\": %" PRId64 "}\n",
+           name,
+           isUpdated ? "true" : "false",
+           heap.peakBytes,
+           heap.allocations,
+           heap.allocatedBytes,
+           heap.liveBytes);
+    return isUpdated ? 0 : 1;
+}
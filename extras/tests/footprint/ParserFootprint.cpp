@@ -0,0 +1,33 @@
+// Built twice, as the dynamic OTA<> and as StaticOTA<StaticVoyagerJSONParser>
+// (VOYAGER_STATIC_PARSER=1), and linked with section garbage collection as the
+// ESP32 toolchain does. CheckParserFootprint.cmake compares the two binaries.
+#define __ENABLE_DEVELOPMENT_MODE__ true
+
+#include <VoyagerOTA.hpp>
+#include "MockVoyager.h"
+
+#if VOYAGER_STATIC_PARSER
+using Client = Voyager::StaticOTA<Voyager::StaticVoyagerJSONParser>;
+#else
+using Client = Voyager::OTA<>;
+#endif
+
+int main() {
+    Shim::reset();
+    MockVoyager::Release release;
+    MockVoyager::serve(release);
+    Shim::esp().throwOnRestart = false;
+
+    Client ota("1.0.0");
+    ota.setBaseURL(MockVoyager::BASE_URL);
+    ota.setCredentials(MockVoyager::PROJECT_ID, MockVoyager::API_KEY);
+
+    auto payload = ota.fetchLatestRelease();
+    if (!payload || !ota.isNewVersion(payload->version)) {
+        return 1;
+    }
+
+    ota.setDownloadURL(payload->downloadURL);
+    ota.performUpdate();
+    return ota.getLastUpdateResult() == HTTP_UPDATE_OK ? 0 : 1;
+}
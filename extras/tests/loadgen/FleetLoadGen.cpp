@@ -0,0 +1,361 @@
+// Fleet load generator: simulates thousands of production devices polling
+// the mock Voyager backend for their latest release with the real client
+// code, and reports latency, throughput, error classes and client CPU as
+// JSON on stdout.
+//
+// Devices run on simulated time from a single event queue, so a day of
+// polling finishes in seconds and runs are reproducible for a given seed.
+// Each device runs its own firmware version with the credentials of one of
+// the fleet's projects, and every check goes through
+// Voyager::OTA<>::fetchLatestRelease(); failures back off exponentially with
+// full jitter, successes wait the poll interval with +-10% jitter. Every
+// reply takes at least the network round trip. Only the release check is
+// exercised, no firmware is downloaded.
+//
+//   FleetLoadGen [--devices N] [--projects N] [--hours H]
+//                [--interval-minutes M] [--server-rps R] [--error-rate P]
+//                [--bad-credentials P] [--outage-minutes M] [--rtt-ms T]
+//                [--seed S]
+#define __ENABLE_DEVELOPMENT_MODE__ false
+
+#include <VoyagerOTA.hpp>
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "MockVoyager.h"
+
+namespace {
+    struct Options {
+        int devices = 2000;
+        int projects = 20;
+        double hours = 24;
+        double intervalMinutes = 60;
+        // Release requests the backend serves per second before answering 429.
+        double serverRequestsPerSecond = 5;
+        double errorRate = 0.01;
+        double badCredentials = 0.01;
+        // Backend unreachable for this long, starting one hour in.
+        double outageMinutes = 10;
+        double roundTripMs = 60;
+        uint32_t seed = 1;
+    };
+
+    struct Device {
+        std::unique_ptr<Voyager::OTA<>> ota;
+        std::string version;
+        std::string projectId;
+        std::string apiKey;
+        int failures = 0;
+    };
+
+    // API keys the backend accepts, with the project each belongs to.
+    using Credentials = std::unordered_map<std::string, std::string>;
+
+    struct Event {
+        uint64_t atMicros;
+        int device;
+
+        bool operator>(const Event& other) const { return atMicros > other.atMicros; }
+    };
+
+    struct StatusCounts {
+        uint64_t ok = 0;
+        uint64_t notModified = 0;
+        uint64_t unauthorized = 0;
+        uint64_t tooManyRequests = 0;
+        uint64_t serverError = 0;
+        uint64_t refused = 0;
+        uint64_t other = 0;
+    };
+
+    constexpr uint64_t MICROS_PER_SECOND = 1000000ULL;
+    constexpr uint64_t BACKOFF_BASE_MICROS = 30 * MICROS_PER_SECOND;
+    constexpr uint64_t BACKOFF_CAP_MICROS = 3600 * MICROS_PER_SECOND;
+    // Time the backend spends looking up a release, on top of the round trip.
+    constexpr uint64_t RELEASE_LOOKUP_MICROS = 20 * 1000;
+
+    uint64_t threadCpuNanos() {
+        timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+    }
+
+    bool parseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            const char* name = argv[i];
+            if (i + 1 >= argc) {
+                fprintf(stderr, "missing value for %s\n", name);
+                return false;
+            }
+            const char* value = argv[++i];
+
+            if (strcmp(name, "--devices") == 0) {
+                options.devices = atoi(value);
+            } else if (strcmp(name, "--projects") == 0) {
+                options.projects = atoi(value);
+            } else if (strcmp(name, "--hours") == 0) {
+                options.hours = atof(value);
+            } else if (strcmp(name, "--interval-minutes") == 0) {
+                options.intervalMinutes = atof(value);
+            } else if (strcmp(name, "--server-rps") == 0) {
+                options.serverRequestsPerSecond = atof(value);
+            } else if (strcmp(name, "--error-rate") == 0) {
+                options.errorRate = atof(value);
+            } else if (strcmp(name, "--bad-credentials") == 0) {
+                options.badCredentials = atof(value);
+            } else if (strcmp(name, "--outage-minutes") == 0) {
+                options.outageMinutes = atof(value);
+            } else if (strcmp(name, "--rtt-ms") == 0) {
+                options.roundTripMs = atof(value);
+            } else if (strcmp(name, "--seed") == 0) {
+                options.seed = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+            } else {
+                fprintf(stderr, "unknown option %s\n", name);
+                return false;
+            }
+        }
+        return options.devices > 0 && options.projects > 0 && options.hours > 0 && options.intervalMinutes > 0 && options.roundTripMs >= 0;
+    }
+
+    // Backend in front of the release route: requests with an unknown key
+    // or a key of another project answer 401, a token bucket on simulated
+    // time answers 429 once the fleet exceeds the configured rate, and a
+    // fraction of the remaining requests fail with 503. On top of the
+    // server's round trip every reply is delayed by an exponentially
+    // distributed jitter of a quarter round trip on average.
+    void serveFleet(const Options& options, const MockVoyager::Release& release, const Credentials& credentials, std::mt19937& random) {
+        std::string body = MockVoyager::releaseJson(release);
+
+        struct Bucket {
+            double tokens;
+            uint64_t refilledAt = 0;
+        };
+        // holds at least one request, so rates below 1/s still get through....
+        double burst = std::max(options.serverRequestsPerSecond, 1.0);
+        auto bucket = std::make_shared<Bucket>(Bucket{burst});
+
+        auto answer = [body, bucket, burst, &options, &credentials, &random](const Shim::HttpRequest& request) {
+            auto key = credentials.find(request.header("x-api-key"));
+            if (key == credentials.end() || key->second != request.header("x-project-id")) {
+                return Shim::HttpResponse::json(401, "{\"message\":\"Unauthorized\"}");
+            }
+
+            uint64_t now = Shim::Clock::nowMicros();
+            double earned = static_cast<double>(now - bucket->refilledAt) * options.serverRequestsPerSecond / MICROS_PER_SECOND;
+            bucket->tokens = std::min(bucket->tokens + earned, burst);
+            bucket->refilledAt = now;
+
+            if (bucket->tokens < 1) {
+                return Shim::HttpResponse::json(429, "{\"message\":\"Too Many Requests\"}").header("Retry-After", "30");
+            }
+            bucket->tokens -= 1;
+
+            if (std::uniform_real_distribution<double>(0, 1)(random) < options.errorRate) {
+                return Shim::HttpResponse::json(503, "{\"message\":\"Service Unavailable\"}");
+            }
+
+            Shim::HttpResponse response = Shim::HttpResponse::json(200, body);
+            response.latencyMicros = RELEASE_LOOKUP_MICROS;
+            return response;
+        };
+
+        std::exponential_distribution<double> jitter(4.0 / std::max(options.roundTripMs * 1000, 1.0));
+        Shim::MockServer::instance().on(MockVoyager::LATEST_RELEASE_PATH, [answer, jitter, &random](const Shim::HttpRequest& request) mutable {
+            Shim::HttpResponse response = answer(request);
+            response.latencyMicros += static_cast<uint64_t>(jitter(random));
+            return response;
+        });
+    }
+
+    uint64_t percentile(std::vector<uint64_t>& samples, double fraction) {
+        if (samples.empty()) {
+            return 0;
+        }
+        size_t index = std::min(samples.size() - 1, static_cast<size_t>(fraction * static_cast<double>(samples.size())));
+        std::nth_element(samples.begin(), samples.begin() + static_cast<long>(index), samples.end());
+        return samples[index];
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+
+    Shim::reset();
+    std::mt19937 random(options.seed);
+    Shim::seedRandom(options.seed);
+
+    uint64_t intervalMicros = static_cast<uint64_t>(options.intervalMinutes * 60 * MICROS_PER_SECOND);
+    uint64_t endMicros = static_cast<uint64_t>(options.hours * 3600 * MICROS_PER_SECOND);
+    uint64_t outageStartMicros = 3600 * MICROS_PER_SECOND;
+    uint64_t outageEndMicros = outageStartMicros + static_cast<uint64_t>(options.outageMinutes * 60 * MICROS_PER_SECOND);
+
+    std::vector<Device> devices(static_cast<size_t>(options.devices));
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    std::uniform_real_distribution<double> unit(0, 1);
+
+    MockVoyager::Release release;
+    Credentials credentials;
+
+    for (int i = 0; i < options.devices; i++) {
+        Device& device = devices[static_cast<size_t>(i)];
+        // the fleet runs the releases it was shipped with, a tenth is
+        // already up to date....
+        device.version = unit(random) < 0.1 ? release.version : "1.0." + std::to_string(random() % 10);
+        device.projectId = "project-" + std::to_string(i % options.projects);
+        device.apiKey = "key-" + std::to_string(i) + "-" + std::to_string(random());
+        if (unit(random) < options.badCredentials) {
+            device.apiKey = "revoked-" + device.apiKey;
+        } else {
+            credentials.emplace(device.apiKey, device.projectId);
+        }
+
+        device.ota = std::make_unique<Voyager::OTA<>>(device.version.c_str());
+        device.ota->setBaseURL(MockVoyager::BASE_URL);
+        device.ota->setCredentials(device.projectId.c_str(), device.apiKey.c_str());
+
+        // devices boot spread over the first poll interval....
+        events.push(Event{static_cast<uint64_t>(unit(random) * static_cast<double>(intervalMicros)), i});
+    }
+
+    serveFleet(options, release, credentials, random);
+    Shim::MockServer& server = Shim::MockServer::instance();
+    server.setRoundTripMicros(static_cast<uint64_t>(options.roundTripMs * 1000));
+    StatusCounts statuses;
+    std::vector<uint64_t> latencies;
+    std::vector<uint64_t> simulatedLatencies;
+    uint64_t clientCpuNanos = 0;
+    uint64_t updatesOffered = 0;
+    bool isOutage = false;
+
+    auto startedAt = std::chrono::steady_clock::now();
+
+    while (!events.empty() && events.top().atMicros < endMicros) {
+        Event event = events.top();
+        events.pop();
+
+        uint64_t now = Shim::Clock::nowMicros();
+        if (event.atMicros > now) {
+            Shim::Clock::advanceMicros(event.atMicros - now);
+        }
+
+        bool shouldBeOut = event.atMicros >= outageStartMicros && event.atMicros < outageEndMicros;
+        if (shouldBeOut != isOutage) {
+            isOutage = shouldBeOut;
+            server.setReachable(!isOutage);
+        }
+
+        Device& device = devices[static_cast<size_t>(event.device)];
+        Shim::MockServer::Stats before = server.stats();
+        uint64_t cpuBefore = threadCpuNanos();
+        auto requestStartedAt = std::chrono::steady_clock::now();
+        uint64_t simulatedStartedAt = Shim::Clock::nowMicros();
+
+        auto latest = device.ota->fetchLatestRelease();
+
+        auto requestEndedAt = std::chrono::steady_clock::now();
+        uint64_t cpuUsed = threadCpuNanos() - cpuBefore;
+        Shim::MockServer::Stats after = server.stats();
+        clientCpuNanos += cpuUsed - std::min(cpuUsed, after.handlerCpuNanos - before.handlerCpuNanos);
+        simulatedLatencies.push_back(Shim::Clock::nowMicros() - simulatedStartedAt);
+        latencies.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(requestEndedAt - requestStartedAt).count()));
+
+        int status = after.requests == before.requests ? HTTPC_ERROR_CONNECTION_REFUSED : server.lastStatus();
+        bool isRetryable = false;
+        switch (status) {
+            case HTTP_CODE_OK:
+                statuses.ok++;
+                break;
+            case HTTP_CODE_NOT_MODIFIED:
+                statuses.notModified++;
+                break;
+            case HTTP_CODE_UNAUTHORIZED:
+                statuses.unauthorized++;
+                break;
+            case HTTP_CODE_TOO_MANY_REQUESTS:
+                statuses.tooManyRequests++;
+                isRetryable = true;
+                break;
+            case HTTPC_ERROR_CONNECTION_REFUSED:
+                statuses.refused++;
+                isRetryable = true;
+                break;
+            default:
+                if (status >= 500) {
+                    statuses.serverError++;
+                    isRetryable = true;
+                } else {
+                    statuses.other++;
+                }
+                break;
+        }
+
+        uint64_t delayMicros;
+        if (isRetryable) {
+            device.failures = std::min(device.failures + 1, 16);
+            uint64_t ceiling = std::min(BACKOFF_CAP_MICROS, BACKOFF_BASE_MICROS << (device.failures - 1));
+            delayMicros = static_cast<uint64_t>(unit(random) * static_cast<double>(ceiling)) + MICROS_PER_SECOND;
+        } else {
+            device.failures = 0;
+            delayMicros = static_cast<uint64_t>(static_cast<double>(intervalMicros) * (0.9 + 0.2 * unit(random)));
+        }
+
+        if (latest && device.ota->isNewVersion(latest->version)) {
+            updatesOffered++;
+        }
+
+        events.push(Event{Shim::Clock::nowMicros() + delayMicros, event.device});
+        Shim::takeSerialOutput();
+    }
+
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startedAt).count();
+    Shim::MockServer::Stats stats = server.stats();
+    uint64_t checks = latencies.size();
+    double deviceDays = options.devices * options.hours / 24.0;
+    uint64_t p50 = percentile(latencies, 0.50);
+    uint64_t p99 = percentile(latencies, 0.99);
+
+    printf("{\n");
+    printf("  \"devices\": %d,\n", options.devices);
+    printf("  \"projects\": %d,\n", options.projects);
+    // "-shim" when built against the ArduinoJson stand-in....
+    printf("  \"arduinoJson\": \"%s\",\n", ARDUINOJSON_VERSION);
+    printf("  \"simulatedHours\": %.1f,\n", options.hours);
+    printf("  \"checks\": %llu,\n", static_cast<unsigned long long>(checks));
+    // real time spent in the client and the mock, and time on the simulated
+    // network, the round trip included....
+    printf("  \"latencyMicros\": {\"p50\": %llu, \"p99\": %llu},\n", static_cast<unsigned long long>(p50), static_cast<unsigned long long>(p99));
+    printf("  \"simulatedLatencyMicros\": {\"p50\": %llu, \"p99\": %llu},\n",
+           static_cast<unsigned long long>(percentile(simulatedLatencies, 0.50)),
+           static_cast<unsigned long long>(percentile(simulatedLatencies, 0.99)));
+    printf("  \"checksPerSecond\": %.0f,\n", elapsedSeconds > 0 ? static_cast<double>(checks) / elapsedSeconds : 0.0);
+    printf("  \"clientCpuMicrosPerCheck\": %.2f,\n", checks > 0 ? static_cast<double>(clientCpuNanos) / 1000.0 / static_cast<double>(checks) : 0.0);
+    // the client sends no conditional requests, so 304 stays at zero....
+    printf("  \"statuses\": {\"200\": %llu, \"304\": %llu, \"401\": %llu, \"429\": %llu, \"5xx\": %llu, \"refused\": %llu, \"other\": %llu},\n",
+           static_cast<unsigned long long>(statuses.ok),
+           static_cast<unsigned long long>(statuses.notModified),
+           static_cast<unsigned long long>(statuses.unauthorized),
+           static_cast<unsigned long long>(statuses.tooManyRequests),
+           static_cast<unsigned long long>(statuses.serverError),
+           static_cast<unsigned long long>(statuses.refused),
+           static_cast<unsigned long long>(statuses.other));
+    // checks that found a newer release than the device runs....
+    printf("  \"updatesOffered\": %llu,\n", static_cast<unsigned long long>(updatesOffered));
+    printf("  \"requestsPerDevicePerDay\": %.2f,\n", static_cast<double>(stats.requests) / deviceDays);
+    printf("  \"bytesPerDevicePerDay\": %.0f\n", static_cast<double>(stats.bytesIn + stats.bytesOut) / deviceDays);
+    printf("}\n");
+
+    devices.clear();
+    Shim::reset();
+    return checks > 0 && statuses.ok > 0 ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+// Subset of the Arduino ESP32 core used by the library, backed by the
+// simulated clock and device state of Shim.h.
+#pragma once
+
+#include <cinttypes>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "Shim.h"
+#include "Stream.h"
+#include "WString.h"
+
+#define LOW 0x0
+#define HIGH 0x1
+
+uint32_t millis();
+
+uint32_t micros();
+
+void delay(uint32_t ms);
+
+void delayMicroseconds(uint32_t us);
+
+void yield();
+
+long random(long max);
+
+long random(long min, long max);
+
+void randomSeed(unsigned long seed);
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t* data, size_t length) override;
+
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getHeapSize();
+    uint32_t getFreeSketchSpace();
+    // Size and MD5 of the image in the running partition, up to its last
+    // programmed byte.
+    uint32_t getSketchSize();
+    String getSketchMD5();
+    uint32_t getFlashChipSize();
+    const char* getSdkVersion();
+    void restart();
+};
+
+extern EspClass ESP;
@@ -0,0 +1,108 @@
+// HTTPClient of the ESP32 core talking to the in-process MockServer.
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Arduino.h"
+#include "WiFi.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+typedef enum {
+    HTTP_CODE_OK = 200,
+    HTTP_CODE_NO_CONTENT = 204,
+    HTTP_CODE_PARTIAL_CONTENT = 206,
+    HTTP_CODE_MOVED_PERMANENTLY = 301,
+    HTTP_CODE_FOUND = 302,
+    HTTP_CODE_SEE_OTHER = 303,
+    HTTP_CODE_NOT_MODIFIED = 304,
+    HTTP_CODE_TEMPORARY_REDIRECT = 307,
+    HTTP_CODE_PERMANENT_REDIRECT = 308,
+    HTTP_CODE_BAD_REQUEST = 400,
+    HTTP_CODE_UNAUTHORIZED = 401,
+    HTTP_CODE_FORBIDDEN = 403,
+    HTTP_CODE_NOT_FOUND = 404,
+    HTTP_CODE_TOO_MANY_REQUESTS = 429,
+    HTTP_CODE_INTERNAL_SERVER_ERROR = 500,
+    HTTP_CODE_BAD_GATEWAY = 502,
+    HTTP_CODE_SERVICE_UNAVAILABLE = 503,
+} t_http_codes;
+
+typedef enum {
+    HTTPC_DISABLE_FOLLOW_REDIRECTS,
+    HTTPC_STRICT_FOLLOW_REDIRECTS,
+    HTTPC_FORCE_FOLLOW_REDIRECTS,
+} followRedirects_t;
+
+class HTTPClient {
+public:
+    HTTPClient() = default;
+
+    HTTPClient(const HTTPClient&) = delete;
+    HTTPClient& operator=(const HTTPClient&) = delete;
+
+    ~HTTPClient();
+
+    bool begin(const String& url);
+    bool begin(WiFiClient& client, const String& url);
+
+    void end();
+
+    bool connected();
+
+    void useHTTP10(bool isEnabled);
+    void setReuse(bool isEnabled);
+    void setTimeout(uint16_t timeoutMs);
+    void setConnectTimeout(int32_t timeoutMs);
+    void setFollowRedirects(followRedirects_t follow);
+    void setUserAgent(const String& userAgent);
+
+    void addHeader(const char* name, const char* value);
+    void addHeader(const String& name, const String& value, bool first = false, bool replace = true);
+
+    void collectHeaders(const char* headerKeys[], const size_t headerKeysCount);
+    String header(const char* name);
+    bool hasHeader(const char* name);
+    int headers();
+
+    int GET();
+    int sendRequest(const char* method, const String& payload = String());
+
+    int getSize();
+    WiFiClient* getStreamPtr();
+    WiFiClient& getStream();
+    String getString();
+
+    static String errorToString(int error);
+
+private:
+    int _send(const char* method, int redirects);
+
+private:
+    std::string _url;
+    bool _isBegun = false;
+    followRedirects_t _followRedirects = HTTPC_DISABLE_FOLLOW_REDIRECTS;
+    std::vector<std::pair<std::string, std::string>> _requestHeaders;
+    std::vector<std::string> _collectedKeys;
+    std::vector<std::pair<std::string, std::string>> _responseHeaders;
+    std::string _userAgent = "ESP32HTTPClient";
+    // a response slower than the TCP timeout is a read timeout, as on the
+    // device. The connect is part of the response latency here....
+    uint16_t _tcpTimeoutMs = 5000;
+    int32_t _connectTimeoutMs = 5000;
+    int _size = -1;
+    WiFiClient _stream;
+    std::shared_ptr<Shim::Connection> _connection;
+};
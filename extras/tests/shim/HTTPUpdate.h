@@ -0,0 +1,29 @@
+// Callback types and error codes of the ESP32 core HTTPUpdate library.
+#pragma once
+
+#include <functional>
+#include "HTTPClient.h"
+#include "Update.h"
+
+#define HTTP_UE_TOO_LESS_SPACE (-100)
+#define HTTP_UE_SERVER_NOT_REPORT_SIZE (-101)
+#define HTTP_UE_SERVER_FILE_NOT_FOUND (-102)
+#define HTTP_UE_SERVER_FORBIDDEN (-103)
+#define HTTP_UE_SERVER_WRONG_HTTP_CODE (-104)
+#define HTTP_UE_SERVER_FAULTY_MD5 (-105)
+#define HTTP_UE_BIN_VERIFY_HEADER_FAILED (-106)
+#define HTTP_UE_BIN_FOR_WRONG_FLASH (-107)
+#define HTTP_UE_NO_PARTITION (-108)
+
+enum HTTPUpdateResult {
+    HTTP_UPDATE_FAILED,
+    HTTP_UPDATE_NO_UPDATES,
+    HTTP_UPDATE_OK,
+};
+
+typedef HTTPUpdateResult t_httpUpdate_return;
+
+using HTTPUpdateStartCB = std::function<void()>;
+using HTTPUpdateEndCB = std::function<void()>;
+using HTTPUpdateErrorCB = std::function<void(int)>;
+using HTTPUpdateProgressCB = std::function<void(int, int)>;
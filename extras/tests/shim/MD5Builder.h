@@ -0,0 +1,28 @@
+// MD5Builder of the ESP32 core, backed by OpenSSL.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "WString.h"
+
+class MD5Builder {
+public:
+    MD5Builder();
+    MD5Builder(const MD5Builder&) = delete;
+    MD5Builder& operator=(const MD5Builder&) = delete;
+    ~MD5Builder();
+
+    void begin();
+    void add(const uint8_t* data, size_t length);
+    void add(const char* data) { add(reinterpret_cast<const uint8_t*>(data), strlen(data)); }
+    void add(const String& data) { add(reinterpret_cast<const uint8_t*>(data.c_str()), data.length()); }
+    void calculate();
+    void getBytes(uint8_t* output) const;
+    void getChars(char* output) const;
+    String toString() const;
+
+private:
+    void* _context = nullptr;
+    uint8_t _digest[16] = {};
+};
@@ -0,0 +1,126 @@
+// In-process HTTP server answering every HTTPClient request of the shim.
+//
+// Responses are delivered over a simulated connection: headers arrive after
+// the response latency, the body trickles in at bytesPerSecond (unlimited
+// when 0) and the sender stalls while receiveWindow bytes are left unread,
+// as TCP does. Time only moves with Shim::Clock, i.e. delay() and the flash
+// model, so a slow reader slows the transfer down just like on the device.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Shim {
+    using HeaderList = std::vector<std::pair<std::string, std::string>>;
+
+    struct HttpRequest {
+        std::string method;
+        std::string host;
+        std::string path;
+        std::string query;
+        HeaderList headers;
+
+        // Empty when the header was not sent, names are case-insensitive.
+        [[nodiscard]] std::string header(const std::string& name) const;
+
+        [[nodiscard]] bool hasHeader(const std::string& name) const;
+    };
+
+    struct HttpResponse {
+        // Data sent on an open connection some time after the headers, e.g.
+        // server-sent events.
+        struct Push {
+            uint64_t afterMicros = 0;
+            std::string data;
+        };
+
+        int status = 200;
+        HeaderList headers;
+        std::string body;
+        // -2 uses the body size, -1 sends no Content-Length.
+        int64_t contentLength = -2;
+
+        uint64_t latencyMicros = 0;
+        uint32_t bytesPerSecond = 0;
+        uint32_t receiveWindow = 5744;
+        // Connection reset once this many body bytes were delivered.
+        int64_t dropAfter = -1;
+        std::vector<Push> pushes;
+        // Server closes the connection this long after the headers.
+        int64_t closeAfterMicros = -1;
+
+        static HttpResponse withStatus(int status, std::string body = std::string());
+
+        static HttpResponse json(int status, std::string body);
+
+        static HttpResponse binary(std::string body);
+
+        HttpResponse& header(std::string name, std::string value);
+    };
+
+    class MockServer {
+    public:
+        using Handler = std::function<HttpResponse(const HttpRequest&)>;
+
+        struct Stats {
+            uint64_t requests = 0;
+            // Approximate bytes on the wire, request and status lines and
+            // headers included, TLS excluded.
+            uint64_t bytesIn = 0;
+            uint64_t bytesOut = 0;
+            // CPU time spent inside handlers, so load generators can tell
+            // client and server cost apart.
+            uint64_t handlerCpuNanos = 0;
+        };
+
+        static MockServer& instance();
+
+        // Routes match the path exactly, the query string is passed along.
+        // A HEAD request on a GET route runs the GET handler and drops the body.
+        void on(const std::string& path, Handler handler, const std::string& method = "GET");
+
+        // While unreachable every request fails with a refused connection.
+        void setReachable(bool isReachable);
+
+        // Network round trip added to the latency of every response, 0 by
+        // default.
+        void setRoundTripMicros(uint64_t roundTripMicros);
+
+        [[nodiscard]] HttpRequest lastRequest() const;
+
+        [[nodiscard]] int lastStatus() const;
+
+        [[nodiscard]] std::vector<HttpRequest> requestLog() const;
+
+        [[nodiscard]] Stats stats() const;
+
+        void resetStats();
+
+        void reset();
+
+        // Used by the HTTPClient shim, returns false when unreachable.
+        bool handle(const HttpRequest& request, HttpResponse& response);
+
+    private:
+        struct Route {
+            std::string method;
+            std::string path;
+            Handler handler;
+        };
+
+        static constexpr size_t MAX_LOGGED_REQUESTS = 256;
+
+        mutable std::mutex _mutex;
+        std::vector<Route> _routes;
+        std::vector<HttpRequest> _log;
+        bool _isReachable = true;
+        uint64_t _roundTripMicros = 0;
+        int _lastStatus = 0;
+        Stats _stats;
+    };
+}  // namespace Shim
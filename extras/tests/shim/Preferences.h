@@ -0,0 +1,37 @@
+// Preferences over an in-memory NVS. Like the real one, opening a namespace
+// read-only fails until something has been written to it, and namespace and
+// key names are limited to 15 characters.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "WString.h"
+
+class Preferences {
+public:
+    Preferences() = default;
+    ~Preferences() { end(); }
+
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end();
+
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBytes(const char* key, const void* value, size_t length);
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buffer, size_t maxLength);
+
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) {
+        uint32_t value = defaultValue;
+        return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+    }
+
+private:
+    std::string _namespace;
+    bool _isOpen = false;
+    bool _isReadOnly = false;
+};
@@ -0,0 +1,132 @@
+// Control surface of the host shim. The Arduino, ESP-IDF, FreeRTOS and
+// mbedtls headers next to this file stand in for the ESP32 core so the
+// library compiles and runs on Linux; tests use the functions below to set
+// up and inspect the simulated device.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Shim {
+    // Simulated time. Nothing sleeps: delay(), flash operations and the
+    // network model advance this clock instead.
+    namespace Clock {
+        uint64_t nowMicros();
+        void advanceMicros(uint64_t micros);
+        void reset();
+    }  // namespace Clock
+
+    struct EspConfig {
+        uint32_t freeHeap = 200 * 1024;
+        uint32_t maxAllocHeap = 110 * 1024;
+        // ESP.restart() throws Shim::Restart unless disabled, so the code
+        // after a reboot is never reached, same as on the device.
+        bool throwOnRestart = true;
+    };
+
+    struct Restart {};
+
+    EspConfig& esp();
+
+    // Number of ESP.restart() calls and bootloader resets since reset().
+    int restartCount();
+
+    // Serial output is captured for the tests to inspect, and printed to
+    // stdout as well when echo is enabled.
+    void setSerialEcho(bool isEnabled);
+
+    std::string takeSerialOutput();
+
+    // Seeds Arduino random() so jitter is reproducible.
+    void seedRandom(uint32_t seed);
+
+    // Allocations made inside the shim (transport, NVS, flash model) are
+    // excluded from heap measurements taken by the tests.
+    extern thread_local int untrackedDepth;
+
+    struct UntrackedScope {
+        UntrackedScope() { ++untrackedDepth; }
+        ~UntrackedScope() { --untrackedDepth; }
+    };
+
+    namespace Flash {
+        constexpr size_t SECTOR_SIZE = 4096;
+
+        struct Config {
+            uint32_t otaPartitionSize = 0x140000;
+            bool hasOtaPartitions = true;
+            bool isEncrypted = false;
+            // CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+            bool isRollbackEnabled = false;
+            uint32_t eraseMicrosPerSector = 45000;
+            uint32_t writeNanosPerByte = 3000;
+        };
+
+        struct Stats {
+            uint64_t sectorsErased = 0;
+            uint64_t bytesWritten = 0;
+            uint64_t eraseMicros = 0;
+            uint64_t writeMicros = 0;
+            // NOR flash can only clear bits, a write over data that was not
+            // erased first corrupts it instead of failing.
+            uint64_t unerasedWrites = 0;
+            uint64_t rejectedWrites = 0;
+        };
+
+        // Resets the partition table to two empty OTA slots, running ota_0.
+        void configure(const Config& config = Config());
+
+        const Config& config();
+
+        Stats& stats();
+
+        // Raw contents of ota_0 or ota_1.
+        std::vector<uint8_t>& contents(int slot);
+
+        // Writes a complete image to the slot, as a serial flash would.
+        void install(int slot, const std::vector<uint8_t>& image);
+    }  // namespace Flash
+
+    namespace Boot {
+        // Reboots through the bootloader model: a NEW image becomes
+        // PENDING_VERIFY, a PENDING_VERIFY image that reboots again is
+        // ABORTED and the other slot is booted, when rollback is enabled.
+        void reset();
+
+        int runningSlot();
+
+        int bootSlot();
+    }  // namespace Boot
+
+    namespace Queues {
+        using ReceiveHook = void (*)(const void* item, void* context);
+
+        // Called on the receiving task right after xQueueReceive() took an
+        // item, lets a test act in the window before the receiver does.
+        void setReceiveHook(ReceiveHook hook, void* context = nullptr);
+
+        // Queues created and not deleted yet.
+        size_t count();
+    }  // namespace Queues
+
+    namespace Tasks {
+        // Waits for every task started with xTaskCreate*() to end.
+        void joinAll();
+
+        size_t count();
+    }  // namespace Tasks
+
+    // Firmware image starting with the ESP32 image magic byte, filled with
+    // a reproducible pattern derived from the seed.
+    std::vector<uint8_t> makeFirmwareImage(size_t size, uint32_t seed = 1);
+
+    std::string toHex(const uint8_t* data, size_t length);
+
+    std::string md5Hex(const std::vector<uint8_t>& data);
+
+    // Resets the clock, flash, NVS, mock server, task registry, queue hook
+    // and ESP config.
+    void reset();
+}  // namespace Shim
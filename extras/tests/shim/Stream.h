@@ -0,0 +1,73 @@
+// Print and Stream base classes of the Arduino core.
+#pragma once
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "WString.h"
+
+class Print {
+public:
+    virtual size_t write(uint8_t value) = 0;
+
+    virtual size_t write(const uint8_t* data, size_t length) {
+        size_t written = 0;
+        while (length-- > 0) {
+            written += write(*data++);
+        }
+        return written;
+    }
+
+    size_t write(const char* text) { return text == nullptr ? 0 : write(reinterpret_cast<const uint8_t*>(text), strlen(text)); }
+
+    size_t print(const String& value) { return write(reinterpret_cast<const uint8_t*>(value.c_str()), value.length()); }
+    size_t print(const char* value) { return write(value); }
+    size_t print(char value) { return write(static_cast<uint8_t>(value)); }
+    size_t print(int value) { return print(String(value)); }
+    size_t print(unsigned int value) { return print(String(value)); }
+    size_t print(long value) { return print(String(value)); }
+    size_t print(unsigned long value) { return print(String(value)); }
+    size_t print(double value) { return print(String(value)); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) {
+        return print(value) + println();
+    }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    virtual ~Print() = default;
+};
+
+inline size_t Print::printf(const char* format, ...) {
+    char buffer[256];
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, arguments);
+    va_end(arguments);
+
+    if (length < 0) {
+        return 0;
+    }
+    return write(reinterpret_cast<const uint8_t*>(buffer), std::min(static_cast<size_t>(length), sizeof(buffer) - 1));
+}
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeoutMs) { _timeoutMs = timeoutMs; }
+
+    // Waits up to the stream timeout for the requested bytes.
+    virtual size_t readBytes(uint8_t* buffer, size_t length);
+
+    size_t readBytes(char* buffer, size_t length) { return readBytes(reinterpret_cast<uint8_t*>(buffer), length); }
+
+protected:
+    unsigned long _timeoutMs = 1000;
+};
@@ -0,0 +1,79 @@
+// UpdateClass of the ESP32 core over the simulated flash. Like the real
+// one it buffers a 4 KB sector, erases it right before writing it, holds
+// back the first 16 bytes until end() and checks the MD5 when one is set.
+#pragma once
+
+#include <memory>
+#include "Arduino.h"
+#include "MD5Builder.h"
+#include "esp_partition.h"
+
+#define UPDATE_ERROR_OK (0)
+#define UPDATE_ERROR_WRITE (1)
+#define UPDATE_ERROR_ERASE (2)
+#define UPDATE_ERROR_READ (3)
+#define UPDATE_ERROR_SPACE (4)
+#define UPDATE_ERROR_SIZE (5)
+#define UPDATE_ERROR_STREAM (6)
+#define UPDATE_ERROR_MD5 (7)
+#define UPDATE_ERROR_MAGIC_BYTE (8)
+#define UPDATE_ERROR_ACTIVATE (9)
+#define UPDATE_ERROR_NO_PARTITION (10)
+#define UPDATE_ERROR_BAD_ARGUMENT (11)
+#define UPDATE_ERROR_ABORT (12)
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+#define U_FLASH 0
+
+class UpdateClass {
+public:
+    bool begin(size_t size = UPDATE_SIZE_UNKNOWN, int command = U_FLASH);
+
+    size_t write(uint8_t* data, size_t length);
+
+    bool end(bool evenIfRemaining = false);
+
+    void abort();
+
+    bool setMD5(const char* expectedMD5);
+
+    String md5String();
+
+    uint8_t getError() const { return _error; }
+    bool hasError() const { return _error != UPDATE_ERROR_OK; }
+    const char* errorString() const;
+    void printError(Print& out) const;
+
+    bool isRunning() const { return _size > 0; }
+    bool isFinished() const { return _progress == _size; }
+    size_t size() const { return _size; }
+    size_t progress() const { return _progress; }
+    size_t remaining() const { return _size - _progress; }
+
+    bool canRollBack();
+    bool rollBack();
+
+private:
+    bool _writeBuffer();
+
+    void _abort(uint8_t error);
+
+    void _reset();
+
+private:
+    static constexpr size_t SECTOR_SIZE = 4096;
+    static constexpr size_t SKIP_SIZE = 16;
+
+    const esp_partition_t* _partition = nullptr;
+    std::unique_ptr<uint8_t[]> _buffer;
+    size_t _bufferLength = 0;
+    uint8_t _skipBuffer[SKIP_SIZE] = {};
+    size_t _size = 0;
+    size_t _progress = 0;
+    uint8_t _error = UPDATE_ERROR_OK;
+    String _targetMD5;
+    MD5Builder _md5;
+};
+
+extern UpdateClass Update;
@@ -0,0 +1,141 @@
+// Arduino String on top of std::string, covering the API used by the
+// library and its examples.
+#pragma once
+
+#include <strings.h>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+class String {
+public:
+    String() = default;
+    String(const char* value) : _value(value != nullptr ? value : "") {}
+    String(const char* value, unsigned int length) : _value(value, length) {}
+    String(const std::string& value) : _value(value) {}
+    String(std::string&& value) : _value(std::move(value)) {}
+    explicit String(char value) : _value(1, value) {}
+    explicit String(int value) : _value(std::to_string(value)) {}
+    explicit String(unsigned int value) : _value(std::to_string(value)) {}
+    explicit String(long value) : _value(std::to_string(value)) {}
+    explicit String(unsigned long value) : _value(std::to_string(value)) {}
+    explicit String(long long value) : _value(std::to_string(value)) {}
+    explicit String(unsigned long long value) : _value(std::to_string(value)) {}
+    explicit String(double value, unsigned int decimals = 2) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+        _value = buffer;
+    }
+
+    const char* c_str() const { return _value.c_str(); }
+    unsigned int length() const { return static_cast<unsigned int>(_value.size()); }
+    bool isEmpty() const { return _value.empty(); }
+    void clear() { _value.clear(); }
+
+    bool reserve(unsigned int size) {
+        _value.reserve(size);
+        return true;
+    }
+
+    bool concat(const String& value) {
+        _value += value._value;
+        return true;
+    }
+    bool concat(const char* value) {
+        if (value == nullptr) {
+            return false;
+        }
+        _value += value;
+        return true;
+    }
+    bool concat(const char* value, unsigned int length) {
+        _value.append(value, length);
+        return true;
+    }
+    bool concat(char value) {
+        _value += value;
+        return true;
+    }
+
+    String& operator+=(const String& value) {
+        concat(value);
+        return *this;
+    }
+    String& operator+=(const char* value) {
+        concat(value);
+        return *this;
+    }
+    String& operator+=(char value) {
+        concat(value);
+        return *this;
+    }
+
+    char operator[](unsigned int index) const { return index < _value.size() ? _value[index] : '\0'; }
+    char& operator[](unsigned int index) { return _value[index]; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+    bool equals(const String& other) const { return _value == other._value; }
+    bool equalsIgnoreCase(const String& other) const { return strcasecmp(c_str(), other.c_str()) == 0; }
+    bool operator==(const String& other) const { return _value == other._value; }
+    bool operator==(const char* other) const { return _value == (other != nullptr ? other : ""); }
+    bool operator!=(const String& other) const { return !(*this == other); }
+    bool operator!=(const char* other) const { return !(*this == other); }
+    bool operator<(const String& other) const { return _value < other._value; }
+
+    bool startsWith(const String& prefix) const { return _value.compare(0, prefix._value.size(), prefix._value) == 0; }
+    bool endsWith(const String& suffix) const {
+        return _value.size() >= suffix._value.size() && _value.compare(_value.size() - suffix._value.size(), suffix._value.size(), suffix._value) == 0;
+    }
+
+    int indexOf(char value, unsigned int from = 0) const { return _position(_value.find(value, from)); }
+    int indexOf(const String& value, unsigned int from = 0) const { return _position(_value.find(value._value, from)); }
+
+    String substring(unsigned int from) const { return from < _value.size() ? String(_value.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) {
+            std::swap(from, to);
+        }
+        return from < _value.size() ? String(_value.substr(from, to - from)) : String();
+    }
+
+    void trim() {
+        size_t begin = _value.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos) {
+            _value.clear();
+            return;
+        }
+        size_t end = _value.find_last_not_of(" \t\r\n");
+        _value = _value.substr(begin, end - begin + 1);
+    }
+
+    void toLowerCase() {
+        for (char& c : _value) {
+            c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        }
+    }
+
+    long toInt() const { return strtol(c_str(), nullptr, 10); }
+
+    const std::string& str() const { return _value; }
+
+    friend String operator+(const String& left, const String& right) { return String(left._value + right._value); }
+    friend String operator+(const String& left, const char* right) { return String(left._value + right); }
+    friend String operator+(const char* left, const String& right) { return String(left + right._value); }
+    friend String operator+(const String& left, char right) { return String(left._value + right); }
+
+    friend std::ostream& operator<<(std::ostream& stream, const String& value) { return stream << value._value; }
+
+private:
+    static int _position(size_t position) { return position == std::string::npos ? -1 : static_cast<int>(position); }
+
+    std::string _value;
+};
+
+// Type of String concatenations in the Arduino core, libraries that adapt
+// String (e.g. ArduinoJson) refer to it as well.
+class StringSumHelper : public String {
+public:
+    using String::String;
+    StringSumHelper(const String& value) : String(value) {}
+};
@@ -0,0 +1,60 @@
+// WiFi station and the TCP client handed out by HTTPClient::getStreamPtr().
+#pragma once
+
+#include <memory>
+#include "Arduino.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6,
+} wl_status_t;
+
+namespace Shim {
+    struct Connection;
+}  // namespace Shim
+
+// Reads from the simulated connection of the last request, see
+// MockServer.h for the network model.
+class WiFiClient : public Stream {
+public:
+    WiFiClient() = default;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(uint8_t* buffer, size_t length) override;
+    using Stream::readBytes;
+
+    size_t write(uint8_t value) override;
+
+    uint8_t connected();
+    void stop();
+
+    void attach(std::shared_ptr<Shim::Connection> connection) { _connection = std::move(connection); }
+
+private:
+    std::shared_ptr<Shim::Connection> _connection;
+};
+
+class WiFiClass {
+public:
+    wl_status_t begin(const char* ssid, const char* password = nullptr) {
+        (void)ssid;
+        (void)password;
+        return WL_CONNECTED;
+    }
+
+    wl_status_t status() { return WL_CONNECTED; }
+
+    bool disconnect() { return true; }
+
+    String macAddress() { return String("24:0A:C4:00:00:01"); }
+
+    String softAPmacAddress() { return String("24:0A:C4:00:00:02"); }
+};
+
+extern WiFiClass WiFi;
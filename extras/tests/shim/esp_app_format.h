@@ -0,0 +1,4 @@
+// Image header constants of ESP-IDF.
+#pragma once
+
+#define ESP_IMAGE_HEADER_MAGIC 0xE9
@@ -0,0 +1,35 @@
+// Partition API of ESP-IDF over the NOR flash model of Shim::Flash. Writes
+// to an encrypted partition must be 16-byte aligned in offset and length.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "esp_err.h"
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_APP_OTA_0 = 0x10,
+    ESP_PARTITION_SUBTYPE_APP_OTA_1 = 0x11,
+} esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* destination, size_t size);
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset, const void* source, size_t size);
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size);
+
+// SHA-256 of the app image in the partition, fails when it holds none.
+esp_err_t esp_partition_get_sha256(const esp_partition_t* partition, uint8_t* sha256);
@@ -0,0 +1,919 @@
+// Minimal stand-in for ArduinoJson 7, only used when configured with
+// -DVOYAGER_ARDUINOJSON_STANDIN=ON, e.g. for offline builds. It is not
+// tuned like the real library, so no measurement is taken against it. Covers what VoyagerOTA and its examples use: JsonDocument,
+// read-only variant access, JSON and MessagePack deserialization and
+// serialization back to a string. Conversions follow ArduinoJson 7, e.g.
+// a missing member converts to the String "null" and to the int 0.
+#pragma once
+
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#define ARDUINOJSON_VERSION "7.0.0-shim"
+#define ARDUINOJSON_VERSION_MAJOR 7
+#define ARDUINOJSON_VERSION_MINOR 0
+#define ARDUINOJSON_VERSION_REVISION 0
+
+class Stream;
+
+namespace ArduinoJson {
+    namespace detail {
+        constexpr int NESTING_LIMIT = 10;
+
+        struct Node {
+            enum class Type : uint8_t { Null, Bool, Int, Float, String, Array, Object };
+
+            Type type = Type::Null;
+            bool boolean = false;
+            int64_t integer = 0;
+            double real = 0;
+            std::string string;
+            // Array elements, or object values paired with keys by index.
+            std::vector<Node> items;
+            std::vector<std::string> keys;
+
+            const Node* member(const char* key) const {
+                if (type != Type::Object || key == nullptr) {
+                    return nullptr;
+                }
+                for (size_t i = 0; i < keys.size(); i++) {
+                    if (keys[i] == key) {
+                        return &items[i];
+                    }
+                }
+                return nullptr;
+            }
+
+            const Node* element(size_t index) const {
+                return type == Type::Array && index < items.size() ? &items[index] : nullptr;
+            }
+        };
+
+        void writeJson(const Node& node, std::string& output);
+
+        void writeMsgPack(const Node& node, std::string& output);
+    }  // namespace detail
+
+    class DeserializationError {
+    public:
+        enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+
+        DeserializationError() = default;
+        DeserializationError(Code code) : _code(code) {}
+
+        explicit operator bool() const { return _code != Ok; }
+
+        Code code() const { return _code; }
+
+        const char* c_str() const {
+            static const char* const MESSAGES[] = {"Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep"};
+            return MESSAGES[_code];
+        }
+
+        friend bool operator==(const DeserializationError& left, Code right) { return left._code == right; }
+        friend bool operator!=(const DeserializationError& left, Code right) { return left._code != right; }
+
+    private:
+        Code _code = Ok;
+    };
+
+    class JsonVariantConst {
+    public:
+        JsonVariantConst() = default;
+        explicit JsonVariantConst(const detail::Node* node) : _node(node) {}
+
+        JsonVariantConst operator[](const char* key) const { return JsonVariantConst(_node == nullptr ? nullptr : _node->member(key)); }
+
+        template <typename T_String, typename = decltype(std::declval<const T_String&>().c_str())>
+        JsonVariantConst operator[](const T_String& key) const {
+            return (*this)[key.c_str()];
+        }
+
+        JsonVariantConst operator[](int index) const { return index < 0 ? JsonVariantConst() : (*this)[static_cast<size_t>(index)]; }
+
+        JsonVariantConst operator[](size_t index) const { return JsonVariantConst(_node == nullptr ? nullptr : _node->element(index)); }
+
+        bool isNull() const { return _node == nullptr || _node->type == detail::Node::Type::Null; }
+
+        size_t size() const { return _node == nullptr ? 0 : _node->items.size(); }
+
+        template <typename T>
+        T as() const {
+            using Type = detail::Node::Type;
+            if constexpr (std::is_same_v<T, bool>) {
+                return _node != nullptr && _node->type == Type::Bool && _node->boolean;
+            } else if constexpr (std::is_arithmetic_v<T>) {
+                if (_node == nullptr) {
+                    return T(0);
+                }
+                if (_node->type == Type::Int) {
+                    return static_cast<T>(_node->integer);
+                }
+                if (_node->type == Type::Float) {
+                    return static_cast<T>(_node->real);
+                }
+                return T(0);
+            } else if constexpr (std::is_same_v<T, const char*>) {
+                return _node != nullptr && _node->type == Type::String ? _node->string.c_str() : nullptr;
+            } else {
+                static_assert(std::is_constructible_v<T, const char*>, "unsupported conversion");
+                if (_node != nullptr && _node->type == Type::String) {
+                    return T(_node->string.c_str());
+                }
+                // like ArduinoJson, anything else converts to its JSON text....
+                std::string text;
+                if (_node == nullptr) {
+                    text = "null";
+                } else {
+                    detail::writeJson(*_node, text);
+                }
+                return T(text.c_str());
+            }
+        }
+
+        template <typename T>
+        bool is() const {
+            using Type = detail::Node::Type;
+            if (_node == nullptr) {
+                return false;
+            }
+            if constexpr (std::is_same_v<T, bool>) {
+                return _node->type == Type::Bool;
+            } else if constexpr (std::is_integral_v<T>) {
+                return _node->type == Type::Int;
+            } else if constexpr (std::is_floating_point_v<T>) {
+                return _node->type == Type::Int || _node->type == Type::Float;
+            } else {
+                return _node->type == Type::String;
+            }
+        }
+
+        template <typename T>
+        operator T() const {
+            return as<T>();
+        }
+
+        const detail::Node* node() const { return _node; }
+
+    private:
+        const detail::Node* _node = nullptr;
+    };
+
+    class JsonDocument {
+    public:
+        JsonDocument() = default;
+
+        JsonVariantConst operator[](const char* key) const { return as()[key]; }
+
+        template <typename T_String, typename = decltype(std::declval<const T_String&>().c_str())>
+        JsonVariantConst operator[](const T_String& key) const {
+            return as()[key.c_str()];
+        }
+
+        JsonVariantConst operator[](int index) const { return as()[index]; }
+
+        JsonVariantConst as() const { return JsonVariantConst(&_root); }
+
+        bool isNull() const { return _root.type == detail::Node::Type::Null; }
+
+        void clear() { _root = detail::Node(); }
+
+        detail::Node& root() { return _root; }
+        const detail::Node& root() const { return _root; }
+
+    private:
+        detail::Node _root;
+    };
+
+    namespace detail {
+        class JsonReader {
+        public:
+            JsonReader(const char* data, size_t length) : _data(data), _end(data + length) {}
+
+            DeserializationError read(Node& node) {
+                _skipSpaces();
+                if (_data == _end) {
+                    return DeserializationError::EmptyInput;
+                }
+                return _value(node, 0);
+            }
+
+        private:
+            void _skipSpaces() {
+                while (_data != _end && (*_data == ' ' || *_data == '\t' || *_data == '\n' || *_data == '\r')) {
+                    _data++;
+                }
+            }
+
+            DeserializationError _value(Node& node, int depth) {
+                _skipSpaces();
+                if (_data == _end) {
+                    return DeserializationError::IncompleteInput;
+                }
+
+                switch (*_data) {
+                    case '{':
+                        return _object(node, depth);
+                    case '[':
+                        return _array(node, depth);
+                    case '"':
+                        node.type = Node::Type::String;
+                        return _string(node.string);
+                    case 't':
+                        node.type = Node::Type::Bool;
+                        node.boolean = true;
+                        return _literal("true");
+                    case 'f':
+                        node.type = Node::Type::Bool;
+                        return _literal("false");
+                    case 'n':
+                        return _literal("null");
+                    default:
+                        return _number(node);
+                }
+            }
+
+            DeserializationError _literal(const char* word) {
+                for (; *word != '\0'; word++, _data++) {
+                    if (_data == _end) {
+                        return DeserializationError::IncompleteInput;
+                    }
+                    if (*_data != *word) {
+                        return DeserializationError::InvalidInput;
+                    }
+                }
+                return DeserializationError::Ok;
+            }
+
+            DeserializationError _number(Node& node) {
+                const char* start = _data;
+                bool isReal = false;
+                while (_data != _end && (isdigit(static_cast<unsigned char>(*_data)) || *_data == '-' || *_data == '+' || *_data == '.' || *_data == 'e' || *_data == 'E')) {
+                    isReal = isReal || *_data == '.' || *_data == 'e' || *_data == 'E';
+                    _data++;
+                }
+                if (start == _data) {
+                    return DeserializationError::InvalidInput;
+                }
+
+                std::string text(start, _data);
+                char* parsedEnd = nullptr;
+                if (!isReal) {
+                    errno = 0;
+                    long long value = strtoll(text.c_str(), &parsedEnd, 10);
+                    if (*parsedEnd == '\0' && errno == 0) {
+                        node.type = Node::Type::Int;
+                        node.integer = value;
+                        return DeserializationError::Ok;
+                    }
+                }
+
+                double value = strtod(text.c_str(), &parsedEnd);
+                if (*parsedEnd != '\0') {
+                    return DeserializationError::InvalidInput;
+                }
+                node.type = Node::Type::Float;
+                node.real = value;
+                return DeserializationError::Ok;
+            }
+
+            static void _appendUtf8(std::string& output, uint32_t codepoint) {
+                if (codepoint < 0x80) {
+                    output += static_cast<char>(codepoint);
+                } else if (codepoint < 0x800) {
+                    output += static_cast<char>(0xC0 | (codepoint >> 6));
+                    output += static_cast<char>(0x80 | (codepoint & 0x3F));
+                } else if (codepoint < 0x10000) {
+                    output += static_cast<char>(0xE0 | (codepoint >> 12));
+                    output += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+                    output += static_cast<char>(0x80 | (codepoint & 0x3F));
+                } else {
+                    output += static_cast<char>(0xF0 | (codepoint >> 18));
+                    output += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+                    output += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+                    output += static_cast<char>(0x80 | (codepoint & 0x3F));
+                }
+            }
+
+            DeserializationError _hex4(uint32_t& value) {
+                value = 0;
+                for (int i = 0; i < 4; i++, _data++) {
+                    if (_data == _end) {
+                        return DeserializationError::IncompleteInput;
+                    }
+                    char digit = *_data;
+                    value <<= 4;
+                    if (digit >= '0' && digit <= '9') {
+                        value |= static_cast<uint32_t>(digit - '0');
+                    } else if (digit >= 'a' && digit <= 'f') {
+                        value |= static_cast<uint32_t>(digit - 'a' + 10);
+                    } else if (digit >= 'A' && digit <= 'F') {
+                        value |= static_cast<uint32_t>(digit - 'A' + 10);
+                    } else {
+                        return DeserializationError::InvalidInput;
+                    }
+                }
+                return DeserializationError::Ok;
+            }
+
+            DeserializationError _string(std::string& output) {
+                _data++;
+                while (true) {
+                    if (_data == _end) {
+                        return DeserializationError::IncompleteInput;
+                    }
+
+                    char current = *_data++;
+                    if (current == '"') {
+                        return DeserializationError::Ok;
+                    }
+                    if (current != '\\') {
+                        output += current;
+                        continue;
+                    }
+
+                    if (_data == _end) {
+                        return DeserializationError::IncompleteInput;
+                    }
+                    char escaped = *_data++;
+                    switch (escaped) {
+                        case '"':
+                        case '\\':
+                        case '/':
+                            output += escaped;
+                            break;
+                        case 'b':
+                            output += '\b';
+                            break;
+                        case 'f':
+                            output += '\f';
+                            break;
+                        case 'n':
+                            output += '\n';
+                            break;
+                        case 'r':
+                            output += '\r';
+                            break;
+                        case 't':
+                            output += '\t';
+                            break;
+                        case 'u': {
+                            uint32_t codepoint = 0;
+                            DeserializationError error = _hex4(codepoint);
+                            if (error) {
+                                return error;
+                            }
+                            if (codepoint >= 0xD800 && codepoint < 0xDC00 && _end - _data >= 6 && _data[0] == '\\' && _data[1] == 'u') {
+                                _data += 2;
+                                uint32_t low = 0;
+                                error = _hex4(low);
+                                if (error) {
+                                    return error;
+                                }
+                                codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                            }
+                            _appendUtf8(output, codepoint);
+                            break;
+                        }
+                        default:
+                            return DeserializationError::InvalidInput;
+                    }
+                }
+            }
+
+            DeserializationError _array(Node& node, int depth) {
+                if (depth >= NESTING_LIMIT) {
+                    return DeserializationError::TooDeep;
+                }
+                _data++;
+                node.type = Node::Type::Array;
+
+                _skipSpaces();
+                if (_data != _end && *_data == ']') {
+                    _data++;
+                    return DeserializationError::Ok;
+                }
+
+                while (true) {
+                    node.items.emplace_back();
+                    DeserializationError error = _value(node.items.back(), depth + 1);
+                    if (error) {
+                        return error;
+                    }
+
+                    _skipSpaces();
+                    if (_data == _end) {
+                        return DeserializationError::IncompleteInput;
+                    }
+                    char separator = *_data++;
+                    if (separator == ']') {
+                        return DeserializationError::Ok;
+                    }
+                    if (separator != ',') {
+                        return DeserializationError::InvalidInput;
+                    }
+                }
+            }
+
+            DeserializationError _object(Node& node, int depth) {
+                if (depth >= NESTING_LIMIT) {
+                    return DeserializationError::TooDeep;
+                }
+                _data++;
+                node.type = Node::Type::Object;
+
+                _skipSpaces();
+                if (_data != _end && *_data == '}') {
+                    _data++;
+                    return DeserializationError::Ok;
+                }
+
+                while (true) {
+                    _skipSpaces();
+                    if (_data == _end) {
+                        return DeserializationError::IncompleteInput;
+                    }
+                    if (*_data != '"') {
+                        return DeserializationError::InvalidInput;
+                    }
+
+                    node.keys.emplace_back();
+                    DeserializationError error = _string(node.keys.back());
+                    if (error) {
+                        return error;
+                    }
+
+                    _skipSpaces();
+                    if (_data == _end) {
+                        return DeserializationError::IncompleteInput;
+                    }
+                    if (*_data++ != ':') {
+                        return DeserializationError::InvalidInput;
+                    }
+
+                    node.items.emplace_back();
+                    error = _value(node.items.back(), depth + 1);
+                    if (error) {
+                        return error;
+                    }
+
+                    _skipSpaces();
+                    if (_data == _end) {
+                        return DeserializationError::IncompleteInput;
+                    }
+                    char separator = *_data++;
+                    if (separator == '}') {
+                        return DeserializationError::Ok;
+                    }
+                    if (separator != ',') {
+                        return DeserializationError::InvalidInput;
+                    }
+                }
+            }
+
+        private:
+            const char* _data;
+            const char* _end;
+        };
+
+        class MsgPackReader {
+        public:
+            MsgPackReader(const char* data, size_t length) : _data(reinterpret_cast<const uint8_t*>(data)), _end(_data + length) {}
+
+            DeserializationError read(Node& node) {
+                if (_data == _end) {
+                    return DeserializationError::EmptyInput;
+                }
+                return _value(node, 0);
+            }
+
+        private:
+            bool _take(uint64_t& value, size_t bytes) {
+                if (static_cast<size_t>(_end - _data) < bytes) {
+                    return false;
+                }
+                value = 0;
+                for (size_t i = 0; i < bytes; i++) {
+                    value = (value << 8) | *_data++;
+                }
+                return true;
+            }
+
+            DeserializationError _bytes(std::string& output, uint64_t length) {
+                if (static_cast<uint64_t>(_end - _data) < length) {
+                    return DeserializationError::IncompleteInput;
+                }
+                output.assign(reinterpret_cast<const char*>(_data), static_cast<size_t>(length));
+                _data += length;
+                return DeserializationError::Ok;
+            }
+
+            DeserializationError _array(Node& node, uint64_t count, int depth) {
+                if (depth >= NESTING_LIMIT) {
+                    return DeserializationError::TooDeep;
+                }
+                node.type = Node::Type::Array;
+                for (uint64_t i = 0; i < count; i++) {
+                    node.items.emplace_back();
+                    DeserializationError error = _value(node.items.back(), depth + 1);
+                    if (error) {
+                        return error;
+                    }
+                }
+                return DeserializationError::Ok;
+            }
+
+            DeserializationError _map(Node& node, uint64_t count, int depth) {
+                if (depth >= NESTING_LIMIT) {
+                    return DeserializationError::TooDeep;
+                }
+                node.type = Node::Type::Object;
+                for (uint64_t i = 0; i < count; i++) {
+                    Node key;
+                    DeserializationError error = _value(key, depth + 1);
+                    if (error) {
+                        return error;
+                    }
+                    if (key.type != Node::Type::String) {
+                        return DeserializationError::InvalidInput;
+                    }
+                    node.keys.push_back(std::move(key.string));
+                    node.items.emplace_back();
+                    error = _value(node.items.back(), depth + 1);
+                    if (error) {
+                        return error;
+                    }
+                }
+                return DeserializationError::Ok;
+            }
+
+            DeserializationError _value(Node& node, int depth) {
+                if (_data == _end) {
+                    return DeserializationError::IncompleteInput;
+                }
+
+                uint8_t type = *_data++;
+                uint64_t value = 0;
+
+                if (type <= 0x7F) {
+                    node.type = Node::Type::Int;
+                    node.integer = type;
+                    return DeserializationError::Ok;
+                }
+                if (type >= 0xE0) {
+                    node.type = Node::Type::Int;
+                    node.integer = static_cast<int8_t>(type);
+                    return DeserializationError::Ok;
+                }
+                if ((type & 0xF0) == 0x80) {
+                    return _map(node, type & 0x0F, depth);
+                }
+                if ((type & 0xF0) == 0x90) {
+                    return _array(node, type & 0x0F, depth);
+                }
+                if ((type & 0xE0) == 0xA0) {
+                    node.type = Node::Type::String;
+                    return _bytes(node.string, type & 0x1F);
+                }
+
+                switch (type) {
+                    case 0xC0:
+                        return DeserializationError::Ok;
+                    case 0xC2:
+                    case 0xC3:
+                        node.type = Node::Type::Bool;
+                        node.boolean = type == 0xC3;
+                        return DeserializationError::Ok;
+                    case 0xC4:
+                    case 0xC5:
+                    case 0xC6:
+                    case 0xD9:
+                    case 0xDA:
+                    case 0xDB: {
+                        size_t width = (type == 0xC4 || type == 0xD9) ? 1 : (type == 0xC5 || type == 0xDA) ? 2 : 4;
+                        if (!_take(value, width)) {
+                            return DeserializationError::IncompleteInput;
+                        }
+                        node.type = Node::Type::String;
+                        return _bytes(node.string, value);
+                    }
+                    case 0xCA: {
+                        if (!_take(value, 4)) {
+                            return DeserializationError::IncompleteInput;
+                        }
+                        uint32_t bits = static_cast<uint32_t>(value);
+                        float real;
+                        memcpy(&real, &bits, sizeof(real));
+                        node.type = Node::Type::Float;
+                        node.real = real;
+                        return DeserializationError::Ok;
+                    }
+                    case 0xCB: {
+                        if (!_take(value, 8)) {
+                            return DeserializationError::IncompleteInput;
+                        }
+                        double real;
+                        memcpy(&real, &value, sizeof(real));
+                        node.type = Node::Type::Float;
+                        node.real = real;
+                        return DeserializationError::Ok;
+                    }
+                    case 0xCC:
+                    case 0xCD:
+                    case 0xCE:
+                    case 0xCF:
+                        if (!_take(value, size_t(1) << (type - 0xCC))) {
+                            return DeserializationError::IncompleteInput;
+                        }
+                        node.type = Node::Type::Int;
+                        node.integer = static_cast<int64_t>(value);
+                        return DeserializationError::Ok;
+                    case 0xD0:
+                    case 0xD1:
+                    case 0xD2:
+                    case 0xD3: {
+                        size_t width = size_t(1) << (type - 0xD0);
+                        if (!_take(value, width)) {
+                            return DeserializationError::IncompleteInput;
+                        }
+                        int shift = static_cast<int>(64 - width * 8);
+                        node.type = Node::Type::Int;
+                        node.integer = shift == 0 ? static_cast<int64_t>(value) : static_cast<int64_t>(value << shift) >> shift;
+                        return DeserializationError::Ok;
+                    }
+                    case 0xDC:
+                    case 0xDD:
+                        if (!_take(value, type == 0xDC ? 2 : 4)) {
+                            return DeserializationError::IncompleteInput;
+                        }
+                        return _array(node, value, depth);
+                    case 0xDE:
+                    case 0xDF:
+                        if (!_take(value, type == 0xDE ? 2 : 4)) {
+                            return DeserializationError::IncompleteInput;
+                        }
+                        return _map(node, value, depth);
+                    default:
+                        return DeserializationError::InvalidInput;
+                }
+            }
+
+        private:
+            const uint8_t* _data;
+            const uint8_t* _end;
+        };
+
+        inline void writeJsonString(const std::string& value, std::string& output) {
+            output += '"';
+            for (char current : value) {
+                switch (current) {
+                    case '"':
+                        output += "\\\"";
+                        break;
+                    case '\\':
+                        output += "\\\\";
+                        break;
+                    case '\n':
+                        output += "\\n";
+                        break;
+                    case '\r':
+                        output += "\\r";
+                        break;
+                    case '\t':
+                        output += "\\t";
+                        break;
+                    default:
+                        if (static_cast<unsigned char>(current) < 0x20) {
+                            char escaped[8];
+                            snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(current));
+                            output += escaped;
+                        } else {
+                            output += current;
+                        }
+                }
+            }
+            output += '"';
+        }
+
+        inline void writeJson(const Node& node, std::string& output) {
+            switch (node.type) {
+                case Node::Type::Null:
+                    output += "null";
+                    break;
+                case Node::Type::Bool:
+                    output += node.boolean ? "true" : "false";
+                    break;
+                case Node::Type::Int:
+                    output += std::to_string(node.integer);
+                    break;
+                case Node::Type::Float: {
+                    char text[32];
+                    snprintf(text, sizeof(text), "%.9g", node.real);
+                    output += text;
+                    break;
+                }
+                case Node::Type::String:
+                    writeJsonString(node.string, output);
+                    break;
+                case Node::Type::Array:
+                    output += '[';
+                    for (size_t i = 0; i < node.items.size(); i++) {
+                        if (i > 0) {
+                            output += ',';
+                        }
+                        writeJson(node.items[i], output);
+                    }
+                    output += ']';
+                    break;
+                case Node::Type::Object:
+                    output += '{';
+                    for (size_t i = 0; i < node.items.size(); i++) {
+                        if (i > 0) {
+                            output += ',';
+                        }
+                        writeJsonString(node.keys[i], output);
+                        output += ':';
+                        writeJson(node.items[i], output);
+                    }
+                    output += '}';
+                    break;
+            }
+        }
+
+        inline void writeBigEndian(uint64_t value, size_t bytes, std::string& output) {
+            for (size_t i = bytes; i > 0; i--) {
+                output += static_cast<char>((value >> ((i - 1) * 8)) & 0xFF);
+            }
+        }
+
+        inline void writeMsgPackString(const std::string& value, std::string& output) {
+            size_t length = value.size();
+            if (length < 32) {
+                output += static_cast<char>(0xA0 | length);
+            } else if (length < 0x100) {
+                output += static_cast<char>(0xD9);
+                writeBigEndian(length, 1, output);
+            } else if (length < 0x10000) {
+                output += static_cast<char>(0xDA);
+                writeBigEndian(length, 2, output);
+            } else {
+                output += static_cast<char>(0xDB);
+                writeBigEndian(length, 4, output);
+            }
+            output += value;
+        }
+
+        inline void writeMsgPackHeader(size_t count, uint8_t fixed, uint8_t wide, std::string& output) {
+            if (count < 16) {
+                output += static_cast<char>(fixed | count);
+            } else if (count < 0x10000) {
+                output += static_cast<char>(wide);
+                writeBigEndian(count, 2, output);
+            } else {
+                output += static_cast<char>(wide + 1);
+                writeBigEndian(count, 4, output);
+            }
+        }
+
+        // Smallest encoding for every value, same as ArduinoJson....
+        inline void writeMsgPack(const Node& node, std::string& output) {
+            switch (node.type) {
+                case Node::Type::Null:
+                    output += static_cast<char>(0xC0);
+                    break;
+                case Node::Type::Bool:
+                    output += static_cast<char>(node.boolean ? 0xC3 : 0xC2);
+                    break;
+                case Node::Type::Int: {
+                    int64_t value = node.integer;
+                    if (value >= 0 && value < 0x80) {
+                        output += static_cast<char>(value);
+                    } else if (value >= -32 && value < 0) {
+                        output += static_cast<char>(static_cast<int8_t>(value));
+                    } else if (value >= 0) {
+                        uint8_t type = value < 0x100 ? 0xCC : value < 0x10000 ? 0xCD : value < 0x100000000LL ? 0xCE : 0xCF;
+                        output += static_cast<char>(type);
+                        writeBigEndian(static_cast<uint64_t>(value), size_t(1) << (type - 0xCC), output);
+                    } else {
+                        uint8_t type = value >= -0x80 ? 0xD0 : value >= -0x8000 ? 0xD1 : value >= -0x80000000LL ? 0xD2 : 0xD3;
+                        output += static_cast<char>(type);
+                        writeBigEndian(static_cast<uint64_t>(value), size_t(1) << (type - 0xD0), output);
+                    }
+                    break;
+                }
+                case Node::Type::Float: {
+                    float narrow = static_cast<float>(node.real);
+                    if (static_cast<double>(narrow) == node.real) {
+                        uint32_t bits;
+                        memcpy(&bits, &narrow, sizeof(bits));
+                        output += static_cast<char>(0xCA);
+                        writeBigEndian(bits, 4, output);
+                    } else {
+                        uint64_t bits;
+                        memcpy(&bits, &node.real, sizeof(bits));
+                        output += static_cast<char>(0xCB);
+                        writeBigEndian(bits, 8, output);
+                    }
+                    break;
+                }
+                case Node::Type::String:
+                    writeMsgPackString(node.string, output);
+                    break;
+                case Node::Type::Array:
+                    writeMsgPackHeader(node.items.size(), 0x90, 0xDC, output);
+                    for (const Node& item : node.items) {
+                        writeMsgPack(item, output);
+                    }
+                    break;
+                case Node::Type::Object:
+                    writeMsgPackHeader(node.items.size(), 0x80, 0xDE, output);
+                    for (size_t i = 0; i < node.items.size(); i++) {
+                        writeMsgPackString(node.keys[i], output);
+                        writeMsgPack(node.items[i], output);
+                    }
+                    break;
+            }
+        }
+
+        template <typename T_Reader>
+        DeserializationError deserialize(JsonDocument& document, const char* data, size_t length) {
+            document.clear();
+            if (data == nullptr) {
+                return DeserializationError::EmptyInput;
+            }
+
+            T_Reader reader(data, length);
+            DeserializationError error = reader.read(document.root());
+            if (error) {
+                document.clear();
+            }
+            return error;
+        }
+
+        std::string readAll(Stream& stream);
+    }  // namespace detail
+
+    inline DeserializationError deserializeJson(JsonDocument& document, const char* data, size_t length) {
+        return detail::deserialize<detail::JsonReader>(document, data, length);
+    }
+
+    inline DeserializationError deserializeJson(JsonDocument& document, const char* data) {
+        return deserializeJson(document, data, data == nullptr ? 0 : strlen(data));
+    }
+
+    template <typename T_String, typename = decltype(std::declval<const T_String&>().c_str()), typename = decltype(std::declval<const T_String&>().length())>
+    DeserializationError deserializeJson(JsonDocument& document, const T_String& input) {
+        return deserializeJson(document, input.c_str(), input.length());
+    }
+
+    template <typename T_Stream, typename = std::enable_if_t<std::is_base_of_v<Stream, T_Stream>>>
+    DeserializationError deserializeJson(JsonDocument& document, T_Stream& input) {
+        std::string data = detail::readAll(input);
+        return deserializeJson(document, data.c_str(), data.size());
+    }
+
+    inline DeserializationError deserializeMsgPack(JsonDocument& document, const char* data, size_t length) {
+        return detail::deserialize<detail::MsgPackReader>(document, data, length);
+    }
+
+    inline DeserializationError deserializeMsgPack(JsonDocument& document, const uint8_t* data, size_t length) {
+        return deserializeMsgPack(document, reinterpret_cast<const char*>(data), length);
+    }
+
+    template <typename T_String, typename = decltype(std::declval<const T_String&>().c_str()), typename = decltype(std::declval<const T_String&>().length())>
+    DeserializationError deserializeMsgPack(JsonDocument& document, const T_String& input) {
+        return deserializeMsgPack(document, input.c_str(), input.length());
+    }
+
+    inline size_t serializeJson(const JsonDocument& document, std::string& output) {
+        output.clear();
+        detail::writeJson(document.root(), output);
+        return output.size();
+    }
+
+    inline size_t serializeMsgPack(const JsonDocument& document, std::string& output) {
+        output.clear();
+        detail::writeMsgPack(document.root(), output);
+        return output.size();
+    }
+}  // namespace ArduinoJson
+
+#include "Stream.h"
+
+inline std::string ArduinoJson::detail::readAll(Stream& stream) {
+    std::string data;
+    uint8_t byte = 0;
+    while (stream.readBytes(&byte, 1) == 1) {
+        data += static_cast<char>(byte);
+    }
+    return data;
+}
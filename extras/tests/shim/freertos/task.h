@@ -0,0 +1,30 @@
+// FreeRTOS tasks as std::threads. Core and priority are recorded but not
+// enforced; vTaskDelete(nullptr) ends the calling task.
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+
+typedef struct ShimTask* TaskHandle_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function,
+                                   const char* name,
+                                   uint32_t stackDepth,
+                                   void* parameter,
+                                   UBaseType_t priority,
+                                   TaskHandle_t* handle,
+                                   BaseType_t core);
+
+BaseType_t xTaskCreate(TaskFunction_t function,
+                       const char* name,
+                       uint32_t stackDepth,
+                       void* parameter,
+                       UBaseType_t priority,
+                       TaskHandle_t* handle);
+
+void vTaskDelete(TaskHandle_t task);
+
+void vTaskDelay(TickType_t ticks);
+
+TickType_t xTaskGetTickCount();
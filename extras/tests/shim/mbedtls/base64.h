@@ -0,0 +1,11 @@
+// Base64 decoding of mbedtls.
+#pragma once
+
+#include <cstddef>
+
+#define MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL (-0x002A)
+#define MBEDTLS_ERR_BASE64_INVALID_CHARACTER (-0x002C)
+
+int mbedtls_base64_decode(unsigned char* destination, size_t capacity, size_t* length, const unsigned char* source, size_t sourceLength);
+
+int mbedtls_base64_encode(unsigned char* destination, size_t capacity, size_t* length, const unsigned char* source, size_t sourceLength);
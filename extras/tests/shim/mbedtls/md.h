@@ -0,0 +1,39 @@
+// Generic message digest API of mbedtls, backed by OpenSSL. Identical in
+// mbedtls 2.x and 3.x.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "version.h"
+
+typedef enum {
+    MBEDTLS_MD_NONE = 0,
+    MBEDTLS_MD_MD5 = 3,
+    MBEDTLS_MD_SHA1 = 4,
+    MBEDTLS_MD_SHA256 = 6,
+} mbedtls_md_type_t;
+
+#define MBEDTLS_ERR_MD_BAD_INPUT_DATA (-0x5100)
+
+typedef struct mbedtls_md_info_t mbedtls_md_info_t;
+
+typedef struct {
+    const mbedtls_md_info_t* info;
+    void* context;
+} mbedtls_md_context_t;
+
+const mbedtls_md_info_t* mbedtls_md_info_from_type(mbedtls_md_type_t type);
+
+unsigned char mbedtls_md_get_size(const mbedtls_md_info_t* info);
+
+void mbedtls_md_init(mbedtls_md_context_t* context);
+
+void mbedtls_md_free(mbedtls_md_context_t* context);
+
+int mbedtls_md_setup(mbedtls_md_context_t* context, const mbedtls_md_info_t* info, int hmac);
+
+int mbedtls_md_starts(mbedtls_md_context_t* context);
+
+int mbedtls_md_update(mbedtls_md_context_t* context, const unsigned char* input, size_t length);
+
+int mbedtls_md_finish(mbedtls_md_context_t* context, unsigned char* output);
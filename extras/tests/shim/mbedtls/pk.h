@@ -0,0 +1,27 @@
+// Public key parsing and verification of mbedtls, backed by OpenSSL.
+#pragma once
+
+#include <cstddef>
+#include "md.h"
+
+#define MBEDTLS_ERR_PK_BAD_INPUT_DATA (-0x3E80)
+#define MBEDTLS_ERR_PK_KEY_INVALID_FORMAT (-0x3D00)
+#define MBEDTLS_ERR_ECP_VERIFY_FAILED (-0x4E00)
+
+typedef struct {
+    void* key;
+} mbedtls_pk_context;
+
+void mbedtls_pk_init(mbedtls_pk_context* context);
+
+void mbedtls_pk_free(mbedtls_pk_context* context);
+
+// The PEM length includes the terminating null byte, as in mbedtls.
+int mbedtls_pk_parse_public_key(mbedtls_pk_context* context, const unsigned char* key, size_t length);
+
+int mbedtls_pk_verify(mbedtls_pk_context* context,
+                      mbedtls_md_type_t type,
+                      const unsigned char* hash,
+                      size_t hashLength,
+                      const unsigned char* signature,
+                      size_t signatureLength);
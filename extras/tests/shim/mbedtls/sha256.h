@@ -0,0 +1,35 @@
+// SHA-256 API of mbedtls. The streaming functions return void in 2.x, with
+// int returning *_ret variants, and int in 3.x.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "version.h"
+
+typedef struct {
+    void* context;
+} mbedtls_sha256_context;
+
+void mbedtls_sha256_init(mbedtls_sha256_context* context);
+
+void mbedtls_sha256_free(mbedtls_sha256_context* context);
+
+#if MBEDTLS_VERSION_MAJOR < 3
+int mbedtls_sha256_starts_ret(mbedtls_sha256_context* context, int is224);
+
+int mbedtls_sha256_update_ret(mbedtls_sha256_context* context, const unsigned char* input, size_t length);
+
+int mbedtls_sha256_finish_ret(mbedtls_sha256_context* context, unsigned char output[32]);
+
+void mbedtls_sha256_starts(mbedtls_sha256_context* context, int is224);
+
+void mbedtls_sha256_update(mbedtls_sha256_context* context, const unsigned char* input, size_t length);
+
+void mbedtls_sha256_finish(mbedtls_sha256_context* context, unsigned char output[32]);
+#else
+int mbedtls_sha256_starts(mbedtls_sha256_context* context, int is224);
+
+int mbedtls_sha256_update(mbedtls_sha256_context* context, const unsigned char* input, size_t length);
+
+int mbedtls_sha256_finish(mbedtls_sha256_context* context, unsigned char output[32]);
+#endif
@@ -0,0 +1,9 @@
+// The shim mimics mbedtls 3.x unless VOYAGER_SHIM_MBEDTLS_VERSION_MAJOR is
+// set to 2, the version shipped with arduino-esp32 2.x.
+#pragma once
+
+#ifndef VOYAGER_SHIM_MBEDTLS_VERSION_MAJOR
+  #define VOYAGER_SHIM_MBEDTLS_VERSION_MAJOR 3
+#endif
+
+#define MBEDTLS_VERSION_MAJOR VOYAGER_SHIM_MBEDTLS_VERSION_MAJOR
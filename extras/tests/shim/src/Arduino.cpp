@@ -0,0 +1,219 @@
+#include <Arduino.h>
+#include <MD5Builder.h>
+#include <MockServer.h>
+#include <WiFi.h>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include "Internal.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+
+namespace Shim {
+    thread_local int untrackedDepth = 0;
+
+    namespace {
+        std::atomic<uint64_t> clockMicros{0};
+        std::atomic<int> restarts{0};
+        EspConfig espConfig;
+
+        std::mutex serialMutex;
+        std::string serialOutput;
+        bool isSerialEchoEnabled = false;
+
+        std::mutex randomMutex;
+        std::mt19937 randomEngine(1);
+    }  // namespace
+
+    uint64_t Clock::nowMicros() {
+        return clockMicros.load();
+    }
+
+    void Clock::advanceMicros(uint64_t micros) {
+        clockMicros.fetch_add(micros);
+    }
+
+    void Clock::reset() {
+        clockMicros.store(0);
+    }
+
+    EspConfig& esp() {
+        return espConfig;
+    }
+
+    int restartCount() {
+        return restarts.load();
+    }
+
+    void countRestart() {
+        restarts.fetch_add(1);
+    }
+
+    void setSerialEcho(bool isEnabled) {
+        std::lock_guard<std::mutex> lock(serialMutex);
+        isSerialEchoEnabled = isEnabled;
+    }
+
+    std::string takeSerialOutput() {
+        UntrackedScope untracked;
+        std::lock_guard<std::mutex> lock(serialMutex);
+        std::string output;
+        output.swap(serialOutput);
+        return output;
+    }
+
+    void seedRandom(uint32_t seed) {
+        std::lock_guard<std::mutex> lock(randomMutex);
+        randomEngine.seed(seed);
+    }
+
+    std::vector<uint8_t> makeFirmwareImage(size_t size, uint32_t seed) {
+        std::vector<uint8_t> image(size);
+        uint32_t state = seed * 2654435761u + 1;
+        for (size_t i = 0; i < size; i++) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            image[i] = static_cast<uint8_t>(state);
+        }
+
+        if (size > 0) {
+            image[0] = 0xE9;
+        }
+        return image;
+    }
+
+    std::string toHex(const uint8_t* data, size_t length) {
+        static const char DIGITS[] = "0123456789abcdef";
+        std::string hex;
+        hex.reserve(length * 2);
+        for (size_t i = 0; i < length; i++) {
+            hex += DIGITS[data[i] >> 4];
+            hex += DIGITS[data[i] & 0x0F];
+        }
+        return hex;
+    }
+
+    std::string md5Hex(const std::vector<uint8_t>& data) {
+        MD5Builder md5;
+        md5.begin();
+        md5.add(data.data(), data.size());
+        md5.calculate();
+        return md5.toString().str();
+    }
+
+    void reset() {
+        UntrackedScope untracked;
+        Tasks::joinAll();
+        Queues::setReceiveHook(nullptr);
+        Clock::reset();
+        restarts.store(0);
+        espConfig = EspConfig();
+        takeSerialOutput();
+        seedRandom(1);
+        Nvs::erase();
+        Flash::configure();
+        MockServer::instance().reset();
+    }
+}  // namespace Shim
+
+uint32_t millis() {
+    return static_cast<uint32_t>(Shim::Clock::nowMicros() / 1000);
+}
+
+uint32_t micros() {
+    return static_cast<uint32_t>(Shim::Clock::nowMicros());
+}
+
+void delay(uint32_t ms) {
+    Shim::Clock::advanceMicros(static_cast<uint64_t>(ms) * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    Shim::Clock::advanceMicros(us);
+}
+
+void yield() {}
+
+long random(long max) {
+    return max <= 0 ? 0 : random(0, max);
+}
+
+long random(long min, long max) {
+    if (max <= min) {
+        return min;
+    }
+
+    std::lock_guard<std::mutex> lock(Shim::randomMutex);
+    return min + static_cast<long>(Shim::randomEngine() % static_cast<uint32_t>(max - min));
+}
+
+void randomSeed(unsigned long seed) {
+    Shim::seedRandom(static_cast<uint32_t>(seed));
+}
+
+size_t HardwareSerial::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t length) {
+    Shim::UntrackedScope untracked;
+    std::lock_guard<std::mutex> lock(Shim::serialMutex);
+    // bounded, long running load tests log on every failed check....
+    if (Shim::serialOutput.size() > (1u << 20)) {
+        Shim::serialOutput.erase(0, Shim::serialOutput.size() / 2);
+    }
+    Shim::serialOutput.append(reinterpret_cast<const char*>(data), length);
+    if (Shim::isSerialEchoEnabled) {
+        std::cout.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(length));
+        std::cout.flush();
+    }
+    return length;
+}
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+    size_t received = 0;
+    uint32_t startedAt = millis();
+    while (received < length) {
+        int value = read();
+        if (value < 0) {
+            if (millis() - startedAt >= _timeoutMs) {
+                break;
+            }
+            delay(1);
+            continue;
+        }
+        buffer[received++] = static_cast<uint8_t>(value);
+    }
+    return received;
+}
+
+uint32_t EspClass::getFreeHeap() {
+    return Shim::esp().freeHeap;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    return Shim::esp().maxAllocHeap;
+}
+
+uint32_t EspClass::getHeapSize() {
+    return 320 * 1024;
+}
+
+uint32_t EspClass::getFlashChipSize() {
+    return 4 * 1024 * 1024;
+}
+
+const char* EspClass::getSdkVersion() {
+    return "v4.4.7";
+}
+
+void EspClass::restart() {
+    Shim::Boot::reset();
+    if (Shim::esp().throwOnRestart) {
+        throw Shim::Restart();
+    }
+}
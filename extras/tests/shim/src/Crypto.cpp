@@ -0,0 +1,317 @@
+#include <MD5Builder.h>
+#include <Shim.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/md.h>
+#include <mbedtls/pk.h>
+#include <mbedtls/sha256.h>
+#include <openssl/bio.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <cstring>
+
+struct mbedtls_md_info_t {
+    mbedtls_md_type_t type;
+    const EVP_MD* (*digest)();
+    unsigned char size;
+};
+
+namespace {
+    const mbedtls_md_info_t MD5_INFO = {MBEDTLS_MD_MD5, &EVP_md5, 16};
+    const mbedtls_md_info_t SHA1_INFO = {MBEDTLS_MD_SHA1, &EVP_sha1, 20};
+    const mbedtls_md_info_t SHA256_INFO = {MBEDTLS_MD_SHA256, &EVP_sha256, 32};
+
+    EVP_MD_CTX* digestOf(void* context) {
+        return static_cast<EVP_MD_CTX*>(context);
+    }
+
+    int sha256Starts(mbedtls_sha256_context* context) {
+        Shim::UntrackedScope untracked;
+        if (context->context == nullptr) {
+            context->context = EVP_MD_CTX_new();
+        }
+        return EVP_DigestInit_ex(digestOf(context->context), EVP_sha256(), nullptr) == 1 ? 0 : -1;
+    }
+
+    int sha256Update(mbedtls_sha256_context* context, const unsigned char* input, size_t length) {
+        return context->context != nullptr && EVP_DigestUpdate(digestOf(context->context), input, length) == 1 ? 0 : -1;
+    }
+
+    int sha256Finish(mbedtls_sha256_context* context, unsigned char output[32]) {
+        unsigned int length = 0;
+        return context->context != nullptr && EVP_DigestFinal_ex(digestOf(context->context), output, &length) == 1 ? 0 : -1;
+    }
+}  // namespace
+
+MD5Builder::MD5Builder() {
+    Shim::UntrackedScope untracked;
+    _context = EVP_MD_CTX_new();
+}
+
+MD5Builder::~MD5Builder() {
+    EVP_MD_CTX_free(digestOf(_context));
+}
+
+void MD5Builder::begin() {
+    memset(_digest, 0, sizeof(_digest));
+    EVP_DigestInit_ex(digestOf(_context), EVP_md5(), nullptr);
+}
+
+void MD5Builder::add(const uint8_t* data, size_t length) {
+    EVP_DigestUpdate(digestOf(_context), data, length);
+}
+
+void MD5Builder::calculate() {
+    unsigned int length = 0;
+    EVP_DigestFinal_ex(digestOf(_context), _digest, &length);
+}
+
+void MD5Builder::getBytes(uint8_t* output) const {
+    memcpy(output, _digest, sizeof(_digest));
+}
+
+void MD5Builder::getChars(char* output) const {
+    std::string hex = Shim::toHex(_digest, sizeof(_digest));
+    memcpy(output, hex.c_str(), hex.size() + 1);
+}
+
+String MD5Builder::toString() const {
+    Shim::UntrackedScope untracked;
+    return String(Shim::toHex(_digest, sizeof(_digest)));
+}
+
+const mbedtls_md_info_t* mbedtls_md_info_from_type(mbedtls_md_type_t type) {
+    switch (type) {
+        case MBEDTLS_MD_MD5:
+            return &MD5_INFO;
+        case MBEDTLS_MD_SHA1:
+            return &SHA1_INFO;
+        case MBEDTLS_MD_SHA256:
+            return &SHA256_INFO;
+        default:
+            return nullptr;
+    }
+}
+
+unsigned char mbedtls_md_get_size(const mbedtls_md_info_t* info) {
+    return info == nullptr ? 0 : info->size;
+}
+
+void mbedtls_md_init(mbedtls_md_context_t* context) {
+    context->info = nullptr;
+    context->context = nullptr;
+}
+
+void mbedtls_md_free(mbedtls_md_context_t* context) {
+    if (context == nullptr) {
+        return;
+    }
+    EVP_MD_CTX_free(digestOf(context->context));
+    mbedtls_md_init(context);
+}
+
+int mbedtls_md_setup(mbedtls_md_context_t* context, const mbedtls_md_info_t* info, int hmac) {
+    if (context == nullptr || info == nullptr || hmac != 0) {
+        return MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+    }
+
+    Shim::UntrackedScope untracked;
+    context->info = info;
+    context->context = EVP_MD_CTX_new();
+    return context->context == nullptr ? MBEDTLS_ERR_MD_BAD_INPUT_DATA : 0;
+}
+
+int mbedtls_md_starts(mbedtls_md_context_t* context) {
+    if (context == nullptr || context->info == nullptr) {
+        return MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+    }
+    return EVP_DigestInit_ex(digestOf(context->context), context->info->digest(), nullptr) == 1 ? 0 : MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+}
+
+int mbedtls_md_update(mbedtls_md_context_t* context, const unsigned char* input, size_t length) {
+    if (context == nullptr || context->info == nullptr) {
+        return MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+    }
+    return EVP_DigestUpdate(digestOf(context->context), input, length) == 1 ? 0 : MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+}
+
+int mbedtls_md_finish(mbedtls_md_context_t* context, unsigned char* output) {
+    if (context == nullptr || context->info == nullptr) {
+        return MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+    }
+    unsigned int length = 0;
+    return EVP_DigestFinal_ex(digestOf(context->context), output, &length) == 1 ? 0 : MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+}
+
+void mbedtls_sha256_init(mbedtls_sha256_context* context) {
+    context->context = nullptr;
+}
+
+void mbedtls_sha256_free(mbedtls_sha256_context* context) {
+    EVP_MD_CTX_free(digestOf(context->context));
+    context->context = nullptr;
+}
+
+// The shim is built against the 3.x declarations. The 2.x void variants
+// share their mangled names, the return value is simply ignored by callers....
+int mbedtls_sha256_starts(mbedtls_sha256_context* context, int is224) {
+    return is224 != 0 ? -1 : sha256Starts(context);
+}
+
+int mbedtls_sha256_update(mbedtls_sha256_context* context, const unsigned char* input, size_t length) {
+    return sha256Update(context, input, length);
+}
+
+int mbedtls_sha256_finish(mbedtls_sha256_context* context, unsigned char output[32]) {
+    return sha256Finish(context, output);
+}
+
+int mbedtls_sha256_starts_ret(mbedtls_sha256_context* context, int is224) {
+    return mbedtls_sha256_starts(context, is224);
+}
+
+int mbedtls_sha256_update_ret(mbedtls_sha256_context* context, const unsigned char* input, size_t length) {
+    return sha256Update(context, input, length);
+}
+
+int mbedtls_sha256_finish_ret(mbedtls_sha256_context* context, unsigned char output[32]) {
+    return sha256Finish(context, output);
+}
+
+void mbedtls_pk_init(mbedtls_pk_context* context) {
+    context->key = nullptr;
+}
+
+void mbedtls_pk_free(mbedtls_pk_context* context) {
+    if (context == nullptr) {
+        return;
+    }
+    EVP_PKEY_free(static_cast<EVP_PKEY*>(context->key));
+    context->key = nullptr;
+}
+
+int mbedtls_pk_parse_public_key(mbedtls_pk_context* context, const unsigned char* key, size_t length) {
+    if (context == nullptr || key == nullptr || length == 0) {
+        return MBEDTLS_ERR_PK_BAD_INPUT_DATA;
+    }
+
+    // as in mbedtls, PEM input must include the terminating null byte....
+    bool isPEM = key[length - 1] == '\0' && strstr(reinterpret_cast<const char*>(key), "-----BEGIN") != nullptr;
+
+    Shim::UntrackedScope untracked;
+    EVP_PKEY* publicKey = nullptr;
+    if (isPEM) {
+        BIO* input = BIO_new_mem_buf(key, static_cast<int>(length - 1));
+        publicKey = PEM_read_bio_PUBKEY(input, nullptr, nullptr, nullptr);
+        BIO_free(input);
+    } else {
+        const unsigned char* cursor = key;
+        publicKey = d2i_PUBKEY(nullptr, &cursor, static_cast<long>(length));
+    }
+
+    if (publicKey == nullptr) {
+        return MBEDTLS_ERR_PK_KEY_INVALID_FORMAT;
+    }
+
+    EVP_PKEY_free(static_cast<EVP_PKEY*>(context->key));
+    context->key = publicKey;
+    return 0;
+}
+
+int mbedtls_pk_verify(mbedtls_pk_context* context,
+                      mbedtls_md_type_t type,
+                      const unsigned char* hash,
+                      size_t hashLength,
+                      const unsigned char* signature,
+                      size_t signatureLength) {
+    const mbedtls_md_info_t* info = mbedtls_md_info_from_type(type);
+    if (context == nullptr || context->key == nullptr || info == nullptr || hashLength != info->size) {
+        return MBEDTLS_ERR_PK_BAD_INPUT_DATA;
+    }
+
+    Shim::UntrackedScope untracked;
+    EVP_PKEY_CTX* verifier = EVP_PKEY_CTX_new(static_cast<EVP_PKEY*>(context->key), nullptr);
+    bool isValid = verifier != nullptr &&
+                   EVP_PKEY_verify_init(verifier) == 1 &&
+                   EVP_PKEY_CTX_set_signature_md(verifier, info->digest()) == 1 &&
+                   EVP_PKEY_verify(verifier, signature, signatureLength, hash, hashLength) == 1;
+    EVP_PKEY_CTX_free(verifier);
+    return isValid ? 0 : MBEDTLS_ERR_ECP_VERIFY_FAILED;
+}
+
+int mbedtls_base64_decode(unsigned char* destination, size_t capacity, size_t* length, const unsigned char* source, size_t sourceLength) {
+    uint32_t accumulator = 0;
+    int bits = 0;
+    size_t written = 0;
+    size_t padding = 0;
+
+    for (size_t i = 0; i < sourceLength; i++) {
+        unsigned char c = source[i];
+        int value;
+        if (c >= 'A' && c <= 'Z') {
+            value = c - 'A';
+        } else if (c >= 'a' && c <= 'z') {
+            value = c - 'a' + 26;
+        } else if (c >= '0' && c <= '9') {
+            value = c - '0' + 52;
+        } else if (c == '+') {
+            value = 62;
+        } else if (c == '/') {
+            value = 63;
+        } else if (c == '=') {
+            padding++;
+            continue;
+        } else if (c == '\r' || c == '\n' || c == ' ') {
+            continue;
+        } else {
+            return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+        }
+
+        // data after padding....
+        if (padding > 0) {
+            return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+        }
+
+        accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            if (written >= capacity) {
+                return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+            }
+            destination[written++] = static_cast<unsigned char>(accumulator >> bits);
+        }
+    }
+
+    if (padding > 2) {
+        return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+    }
+
+    *length = written;
+    return 0;
+}
+
+int mbedtls_base64_encode(unsigned char* destination, size_t capacity, size_t* length, const unsigned char* source, size_t sourceLength) {
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t required = ((sourceLength + 2) / 3) * 4 + 1;
+    *length = required;
+    if (capacity < required) {
+        return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+    }
+
+    size_t written = 0;
+    for (size_t i = 0; i < sourceLength; i += 3) {
+        uint32_t block = static_cast<uint32_t>(source[i]) << 16;
+        block |= i + 1 < sourceLength ? static_cast<uint32_t>(source[i + 1]) << 8 : 0;
+        block |= i + 2 < sourceLength ? source[i + 2] : 0;
+
+        destination[written++] = ALPHABET[(block >> 18) & 0x3F];
+        destination[written++] = ALPHABET[(block >> 12) & 0x3F];
+        destination[written++] = i + 1 < sourceLength ? ALPHABET[(block >> 6) & 0x3F] : '=';
+        destination[written++] = i + 2 < sourceLength ? ALPHABET[block & 0x3F] : '=';
+    }
+
+    destination[written] = '\0';
+    *length = written;
+    return 0;
+}
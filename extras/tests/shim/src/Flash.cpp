@@ -0,0 +1,504 @@
+#include <Arduino.h>
+#include <Update.h>
+#include <esp_app_format.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <mbedtls/sha256.h>
+#include <MD5Builder.h>
+#include <mutex>
+#include "Internal.h"
+
+UpdateClass Update;
+
+namespace {
+    constexpr uint32_t FIRST_OTA_ADDRESS = 0x10000;
+    constexpr size_t ENCRYPTED_BLOCK_SIZE = 16;
+
+    struct Slot {
+        esp_partition_t partition;
+        std::vector<uint8_t> contents;
+        esp_ota_img_states_t state = ESP_OTA_IMG_UNDEFINED;
+    };
+
+    std::recursive_mutex flashMutex;
+    Shim::Flash::Config flashConfig;
+    Shim::Flash::Stats flashStats;
+    Slot slots[2];
+    int activeSlot = 0;
+    int nextBootSlot = 0;
+
+    int slotOf(const esp_partition_t* partition) {
+        for (int slot = 0; slot < 2; slot++) {
+            if (partition == &slots[slot].partition) {
+                return slot;
+            }
+        }
+        return -1;
+    }
+
+    bool isBootable(int slot) {
+        const Slot& candidate = slots[slot];
+        return candidate.contents[0] == ESP_IMAGE_HEADER_MAGIC && candidate.state != ESP_OTA_IMG_INVALID && candidate.state != ESP_OTA_IMG_ABORTED;
+    }
+
+    bool isInRange(const esp_partition_t* partition, size_t offset, size_t size) {
+        return slotOf(partition) >= 0 && offset <= partition->size && size <= partition->size - offset;
+    }
+
+    // The image in a slot, up to its last programmed byte.
+    size_t imageLength(int slot) {
+        const std::vector<uint8_t>& contents = slots[slot].contents;
+        size_t length = contents.size();
+        while (length > 0 && contents[length - 1] == 0xFF) {
+            length--;
+        }
+        return length;
+    }
+}  // namespace
+
+void Shim::Flash::configure(const Config& config) {
+    UntrackedScope untracked;
+    std::lock_guard<std::recursive_mutex> lock(flashMutex);
+    flashConfig = config;
+    flashStats = Stats();
+
+    for (int slot = 0; slot < 2; slot++) {
+        esp_partition_t& partition = slots[slot].partition;
+        partition = esp_partition_t();
+        partition.type = ESP_PARTITION_TYPE_APP;
+        partition.subtype = slot == 0 ? ESP_PARTITION_SUBTYPE_APP_OTA_0 : ESP_PARTITION_SUBTYPE_APP_OTA_1;
+        partition.address = FIRST_OTA_ADDRESS + slot * config.otaPartitionSize;
+        partition.size = config.otaPartitionSize;
+        partition.encrypted = config.isEncrypted;
+        snprintf(partition.label, sizeof(partition.label), "ota_%d", slot);
+
+        slots[slot].contents.assign(config.otaPartitionSize, 0xFF);
+        slots[slot].state = ESP_OTA_IMG_UNDEFINED;
+    }
+
+    // the firmware running the tests....
+    std::vector<uint8_t> firmware = makeFirmwareImage(64 * 1024, 0);
+    std::copy(firmware.begin(), firmware.end(), slots[0].contents.begin());
+    slots[0].state = config.isRollbackEnabled ? ESP_OTA_IMG_VALID : ESP_OTA_IMG_UNDEFINED;
+    activeSlot = 0;
+    nextBootSlot = 0;
+}
+
+const Shim::Flash::Config& Shim::Flash::config() {
+    return flashConfig;
+}
+
+Shim::Flash::Stats& Shim::Flash::stats() {
+    return flashStats;
+}
+
+std::vector<uint8_t>& Shim::Flash::contents(int slot) {
+    return slots[slot].contents;
+}
+
+void Shim::Flash::install(int slot, const std::vector<uint8_t>& image) {
+    UntrackedScope untracked;
+    std::lock_guard<std::recursive_mutex> lock(flashMutex);
+    std::vector<uint8_t>& contents = slots[slot].contents;
+    std::fill(contents.begin(), contents.end(), 0xFF);
+    std::copy(image.begin(), image.begin() + std::min(image.size(), contents.size()), contents.begin());
+    slots[slot].state = flashConfig.isRollbackEnabled ? ESP_OTA_IMG_VALID : ESP_OTA_IMG_UNDEFINED;
+}
+
+void Shim::Boot::reset() {
+    std::lock_guard<std::recursive_mutex> lock(flashMutex);
+    int slot = nextBootSlot;
+
+    if (flashConfig.isRollbackEnabled) {
+        Slot& candidate = slots[slot];
+        // an image still unconfirmed on the next boot is given up on....
+        if (candidate.state == ESP_OTA_IMG_PENDING_VERIFY) {
+            candidate.state = ESP_OTA_IMG_ABORTED;
+        } else if (candidate.state == ESP_OTA_IMG_NEW) {
+            candidate.state = ESP_OTA_IMG_PENDING_VERIFY;
+        }
+    }
+
+    if (!isBootable(slot) && isBootable(1 - slot)) {
+        slot = 1 - slot;
+        nextBootSlot = slot;
+    }
+
+    activeSlot = slot;
+    countRestart();
+}
+
+int Shim::Boot::runningSlot() {
+    return activeSlot;
+}
+
+int Shim::Boot::bootSlot() {
+    return nextBootSlot;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* destination, size_t size) {
+    std::lock_guard<std::recursive_mutex> lock(flashMutex);
+    if (!isInRange(partition, offset, size) || destination == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memcpy(destination, slots[slotOf(partition)].contents.data() + offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset, const void* source, size_t size) {
+    std::lock_guard<std::recursive_mutex> lock(flashMutex);
+    if (!isInRange(partition, offset, size) || source == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // flash encryption works on 16 byte blocks....
+    if (partition->encrypted && (offset % ENCRYPTED_BLOCK_SIZE != 0 || size % ENCRYPTED_BLOCK_SIZE != 0)) {
+        flashStats.rejectedWrites++;
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint8_t* destination = slots[slotOf(partition)].contents.data() + offset;
+    const uint8_t* bytes = static_cast<const uint8_t*>(source);
+    bool isErased = true;
+    for (size_t i = 0; i < size; i++) {
+        isErased &= destination[i] == 0xFF;
+        // NOR flash can only clear bits....
+        destination[i] &= bytes[i];
+    }
+
+    if (!isErased) {
+        flashStats.unerasedWrites++;
+    }
+
+    uint64_t writeMicros = (static_cast<uint64_t>(size) * flashConfig.writeNanosPerByte) / 1000;
+    flashStats.bytesWritten += size;
+    flashStats.writeMicros += writeMicros;
+    Shim::Clock::advanceMicros(writeMicros);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+    std::lock_guard<std::recursive_mutex> lock(flashMutex);
+    if (!isInRange(partition, offset, size) || offset % Shim::Flash::SECTOR_SIZE != 0 || size % Shim::Flash::SECTOR_SIZE != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    std::vector<uint8_t>& contents = slots[slotOf(partition)].contents;
+    std::fill(contents.begin() + offset, contents.begin() + offset + size, 0xFF);
+
+    uint64_t sectors = size / Shim::Flash::SECTOR_SIZE;
+    uint64_t eraseMicros = sectors * flashConfig.eraseMicrosPerSector;
+    flashStats.sectorsErased += sectors;
+    flashStats.eraseMicros += eraseMicros;
+    Shim::Clock::advanceMicros(eraseMicros);
+    return ESP_OK;
+}
+
+const esp_partition_t* esp_ota_get_running_partition() {
+    return &slots[activeSlot].partition;
+}
+
+const esp_partition_t* esp_ota_get_boot_partition() {
+    return &slots[nextBootSlot].partition;
+}
+
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* startFrom) {
+    (void)startFrom;
+    if (!flashConfig.hasOtaPartitions) {
+        return nullptr;
+    }
+    return &slots[1 - activeSlot].partition;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition) {
+    std::lock_guard<std::recursive_mutex> lock(flashMutex);
+    int slot = slotOf(partition);
+    if (slot < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // the image header is validated before switching....
+    if (slots[slot].contents[0] != ESP_IMAGE_HEADER_MAGIC) {
+        return ESP_ERR_OTA_VALIDATE_FAILED;
+    }
+
+    if (slot != activeSlot) {
+        slots[slot].state = flashConfig.isRollbackEnabled ? ESP_OTA_IMG_NEW : ESP_OTA_IMG_UNDEFINED;
+    }
+    nextBootSlot = slot;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_get_state_partition(const esp_partition_t* partition, esp_ota_img_states_t* state) {
+    int slot = slotOf(partition);
+    if (slot < 0 || state == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *state = slots[slot].state;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback() {
+    std::lock_guard<std::recursive_mutex> lock(flashMutex);
+    slots[activeSlot].state = ESP_OTA_IMG_VALID;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_invalid_rollback_and_reboot() {
+    {
+        std::lock_guard<std::recursive_mutex> lock(flashMutex);
+        if (!esp_ota_check_rollback_is_possible()) {
+            return ESP_ERR_OTA_ROLLBACK_FAILED;
+        }
+
+        slots[activeSlot].state = ESP_OTA_IMG_INVALID;
+        nextBootSlot = 1 - activeSlot;
+    }
+
+    ESP.restart();
+    return ESP_OK;
+}
+
+bool esp_ota_check_rollback_is_possible() {
+    std::lock_guard<std::recursive_mutex> lock(flashMutex);
+    return flashConfig.hasOtaPartitions && isBootable(1 - activeSlot);
+}
+
+esp_err_t esp_partition_get_sha256(const esp_partition_t* partition, uint8_t* sha256) {
+    std::lock_guard<std::recursive_mutex> lock(flashMutex);
+    int slot = slotOf(partition);
+    if (slot < 0 || sha256 == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (slots[slot].contents[0] != ESP_IMAGE_HEADER_MAGIC) {
+        return ESP_ERR_IMAGE_INVALID;
+    }
+
+    mbedtls_sha256_context context;
+    mbedtls_sha256_init(&context);
+    int result = mbedtls_sha256_starts(&context, 0);
+    result = result != 0 ? result : mbedtls_sha256_update(&context, slots[slot].contents.data(), imageLength(slot));
+    result = result != 0 ? result : mbedtls_sha256_finish(&context, sha256);
+    mbedtls_sha256_free(&context);
+    return result == 0 ? ESP_OK : ESP_FAIL;
+}
+
+uint32_t EspClass::getSketchSize() {
+    std::lock_guard<std::recursive_mutex> lock(flashMutex);
+    return static_cast<uint32_t>(imageLength(activeSlot));
+}
+
+String EspClass::getSketchMD5() {
+    Shim::UntrackedScope untracked;
+    std::lock_guard<std::recursive_mutex> lock(flashMutex);
+    MD5Builder md5;
+    md5.begin();
+    md5.add(slots[activeSlot].contents.data(), imageLength(activeSlot));
+    md5.calculate();
+    return md5.toString();
+}
+
+uint32_t EspClass::getFreeSketchSpace() {
+    const esp_partition_t* partition = esp_ota_get_next_update_partition(nullptr);
+    return partition == nullptr ? 0 : partition->size;
+}
+
+bool UpdateClass::begin(size_t size, int command) {
+    (void)command;
+    if (_size > 0) {
+        return false;
+    }
+
+    _reset();
+    _error = UPDATE_ERROR_OK;
+
+    if (size == 0) {
+        _error = UPDATE_ERROR_SIZE;
+        return false;
+    }
+
+    _partition = esp_ota_get_next_update_partition(nullptr);
+    if (_partition == nullptr) {
+        _error = UPDATE_ERROR_NO_PARTITION;
+        return false;
+    }
+
+    if (size == UPDATE_SIZE_UNKNOWN) {
+        size = _partition->size;
+    } else if (size > _partition->size) {
+        _error = UPDATE_ERROR_SIZE;
+        return false;
+    }
+
+    // the sector buffer is heap allocated on the device as well, so it is
+    // deliberately left visible to heap measurements....
+    _buffer.reset(new (std::nothrow) uint8_t[SECTOR_SIZE]);
+    if (_buffer == nullptr) {
+        _error = UPDATE_ERROR_SPACE;
+        return false;
+    }
+
+    _size = size;
+    _md5.begin();
+    return true;
+}
+
+size_t UpdateClass::write(uint8_t* data, size_t length) {
+    if (hasError() || !isRunning()) {
+        return 0;
+    }
+
+    if (_bufferLength + length > remaining()) {
+        _abort(UPDATE_ERROR_SPACE);
+        return 0;
+    }
+
+    size_t left = length;
+    while (_bufferLength + left > SECTOR_SIZE) {
+        size_t toBuffer = SECTOR_SIZE - _bufferLength;
+        memcpy(_buffer.get() + _bufferLength, data + (length - left), toBuffer);
+        _bufferLength += toBuffer;
+        if (!_writeBuffer()) {
+            return length - left;
+        }
+        left -= toBuffer;
+    }
+
+    memcpy(_buffer.get() + _bufferLength, data + (length - left), left);
+    _bufferLength += left;
+    if (_bufferLength == remaining() && !_writeBuffer()) {
+        return length - left;
+    }
+
+    return length;
+}
+
+bool UpdateClass::_writeBuffer() {
+    size_t skip = 0;
+    if (_progress == 0) {
+        if (_buffer[0] != ESP_IMAGE_HEADER_MAGIC) {
+            _abort(UPDATE_ERROR_MAGIC_BYTE);
+            return false;
+        }
+
+        // written last, so a partially written image never looks bootable....
+        skip = SKIP_SIZE;
+        memcpy(_skipBuffer, _buffer.get(), SKIP_SIZE);
+    }
+
+    if (_progress % SECTOR_SIZE == 0 && esp_partition_erase_range(_partition, _progress, SECTOR_SIZE) != ESP_OK) {
+        _abort(UPDATE_ERROR_ERASE);
+        return false;
+    }
+
+    // the tail of the image is padded to the encryption block size....
+    size_t writeLength = _bufferLength - skip;
+    size_t padded = ((_bufferLength + ENCRYPTED_BLOCK_SIZE - 1) / ENCRYPTED_BLOCK_SIZE) * ENCRYPTED_BLOCK_SIZE - skip;
+    uint8_t* source = _buffer.get() + skip;
+    if (padded != writeLength) {
+        memset(source + writeLength, 0xFF, padded - writeLength);
+    }
+
+    if (esp_partition_write(_partition, _progress + skip, source, padded) != ESP_OK) {
+        _abort(UPDATE_ERROR_WRITE);
+        return false;
+    }
+
+    _md5.add(_buffer.get(), _bufferLength);
+    _progress += _bufferLength;
+    _bufferLength = 0;
+    return true;
+}
+
+bool UpdateClass::end(bool evenIfRemaining) {
+    if (hasError() || _size == 0) {
+        return false;
+    }
+
+    if (!isFinished() && !evenIfRemaining) {
+        _abort(UPDATE_ERROR_ABORT);
+        return false;
+    }
+
+    if (evenIfRemaining) {
+        if (_bufferLength > 0 && !_writeBuffer()) {
+            return false;
+        }
+        _size = _progress;
+    }
+
+    _md5.calculate();
+    if (_targetMD5.length() > 0 && _targetMD5 != _md5.toString()) {
+        _abort(UPDATE_ERROR_MD5);
+        return false;
+    }
+
+    if (esp_partition_write(_partition, 0, _skipBuffer, SKIP_SIZE) != ESP_OK || esp_ota_set_boot_partition(_partition) != ESP_OK) {
+        _abort(UPDATE_ERROR_ACTIVATE);
+        return false;
+    }
+
+    _reset();
+    return true;
+}
+
+void UpdateClass::abort() {
+    _abort(UPDATE_ERROR_ABORT);
+}
+
+bool UpdateClass::setMD5(const char* expectedMD5) {
+    if (expectedMD5 == nullptr || strlen(expectedMD5) != 32) {
+        return false;
+    }
+
+    _targetMD5 = expectedMD5;
+    _targetMD5.toLowerCase();
+    return true;
+}
+
+String UpdateClass::md5String() {
+    return _md5.toString();
+}
+
+const char* UpdateClass::errorString() const {
+    static const char* const MESSAGES[] = {
+        "No Error", "Flash Write Failed", "Flash Erase Failed", "Flash Read Failed", "Not Enough Space",
+        "Bad Size Given", "Stream Read Timeout", "MD5 Check Failed", "Wrong Magic Byte", "Could Not Activate The Firmware",
+        "Partition Could Not be Found", "Bad Argument", "Aborted",
+    };
+    return _error < sizeof(MESSAGES) / sizeof(MESSAGES[0]) ? MESSAGES[_error] : "UNKNOWN";
+}
+
+void UpdateClass::printError(Print& out) const {
+    out.println(errorString());
+}
+
+bool UpdateClass::canRollBack() {
+    if (_buffer != nullptr) {
+        return false;
+    }
+
+    const esp_partition_t* partition = esp_ota_get_next_update_partition(nullptr);
+    return partition != nullptr && slots[slotOf(partition)].contents[0] == ESP_IMAGE_HEADER_MAGIC;
+}
+
+bool UpdateClass::rollBack() {
+    // switches to the other partition, whatever image it holds....
+    return canRollBack() && esp_ota_set_boot_partition(esp_ota_get_next_update_partition(nullptr)) == ESP_OK;
+}
+
+void UpdateClass::_abort(uint8_t error) {
+    _reset();
+    _error = error;
+}
+
+void UpdateClass::_reset() {
+    _buffer.reset();
+    _bufferLength = 0;
+    _size = 0;
+    _progress = 0;
+    _partition = nullptr;
+    _targetMD5.clear();
+}
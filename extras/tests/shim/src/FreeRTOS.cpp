@@ -0,0 +1,216 @@
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <Shim.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ShimQueue {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::vector<uint8_t>> items;
+    size_t length = 0;
+    size_t itemSize = 0;
+};
+
+struct ShimTask {
+    std::thread thread;
+};
+
+namespace {
+    // Thrown by vTaskDelete(nullptr) to unwind the calling task.
+    struct TaskExit {};
+
+    std::mutex tasksMutex;
+    std::vector<ShimTask*> tasks;
+
+    const auto startedAt = std::chrono::steady_clock::now();
+
+    std::atomic<Shim::Queues::ReceiveHook> receiveHook{nullptr};
+    std::atomic<void*> receiveHookContext{nullptr};
+
+    std::atomic<size_t> queueCount{0};
+
+    template <typename T_Predicate>
+    bool waitFor(ShimQueue* queue, std::unique_lock<std::mutex>& lock, TickType_t ticksToWait, T_Predicate predicate) {
+        if (ticksToWait == portMAX_DELAY) {
+            queue->changed.wait(lock, predicate);
+            return true;
+        }
+        return queue->changed.wait_for(lock, std::chrono::milliseconds(ticksToWait), predicate);
+    }
+
+    BaseType_t send(QueueHandle_t queue, const void* item, TickType_t ticksToWait, bool toFront) {
+        Shim::UntrackedScope untracked;
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        if (!waitFor(queue, lock, ticksToWait, [queue] { return queue->items.size() < queue->length; })) {
+            return pdFAIL;
+        }
+
+        const uint8_t* bytes = static_cast<const uint8_t*>(item);
+        std::vector<uint8_t> copy(bytes, bytes + queue->itemSize);
+        if (toFront) {
+            queue->items.push_front(std::move(copy));
+        } else {
+            queue->items.push_back(std::move(copy));
+        }
+        queue->changed.notify_all();
+        return pdPASS;
+    }
+}  // namespace
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    Shim::UntrackedScope untracked;
+    if (length == 0 || itemSize == 0) {
+        return nullptr;
+    }
+
+    ShimQueue* queue = new ShimQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    queueCount++;
+    return queue;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return send(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return send(queue, item, ticksToWait, true);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    Shim::UntrackedScope untracked;
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitFor(queue, lock, ticksToWait, [queue] { return !queue->items.empty(); })) {
+        return pdFAIL;
+    }
+
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    queue->changed.notify_all();
+    lock.unlock();
+
+    Shim::Queues::ReceiveHook hook = receiveHook.load();
+    if (hook != nullptr) {
+        hook(item, receiveHookContext.load());
+    }
+    return pdPASS;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    Shim::UntrackedScope untracked;
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->items.clear();
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return static_cast<UBaseType_t>(queue->items.size());
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    Shim::UntrackedScope untracked;
+    if (queue != nullptr) {
+        queueCount--;
+    }
+    delete queue;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function,
+                                   const char* name,
+                                   uint32_t stackDepth,
+                                   void* parameter,
+                                   UBaseType_t priority,
+                                   TaskHandle_t* handle,
+                                   BaseType_t core) {
+    (void)name;
+    (void)stackDepth;
+    (void)priority;
+    (void)core;
+
+    Shim::UntrackedScope untracked;
+    ShimTask* task = new ShimTask();
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        tasks.push_back(task);
+    }
+
+    task->thread = std::thread([function, parameter] {
+        try {
+            function(parameter);
+        } catch (const TaskExit&) {
+        } catch (const Shim::Restart&) {
+            // the device rebooted from within the task....
+        }
+    });
+
+    if (handle != nullptr) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function,
+                       const char* name,
+                       uint32_t stackDepth,
+                       void* parameter,
+                       UBaseType_t priority,
+                       TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(function, name, stackDepth, parameter, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // only self deletion is supported, the way the library uses it....
+    if (task == nullptr) {
+        throw TaskExit();
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+TickType_t xTaskGetTickCount() {
+    auto elapsed = std::chrono::steady_clock::now() - startedAt;
+    return static_cast<TickType_t>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+}
+
+namespace Shim {
+    void Queues::setReceiveHook(ReceiveHook hook, void* context) {
+        receiveHookContext.store(context);
+        receiveHook.store(hook);
+    }
+
+    size_t Queues::count() {
+        return queueCount.load();
+    }
+
+    void Tasks::joinAll() {
+        std::vector<ShimTask*> finished;
+        {
+            std::lock_guard<std::mutex> lock(tasksMutex);
+            finished.swap(tasks);
+        }
+
+        for (ShimTask* task : finished) {
+            if (task->thread.joinable()) {
+                task->thread.join();
+            }
+            delete task;
+        }
+    }
+
+    size_t Tasks::count() {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        return tasks.size();
+    }
+}  // namespace Shim
@@ -0,0 +1,594 @@
+#include <HTTPClient.h>
+#include <MockServer.h>
+#include <strings.h>
+#include <time.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Shim {
+    // Body bytes of one response as seen by the receiver, see MockServer.h.
+    struct Connection {
+        std::string data;
+        // (time the bytes are sent, end offset in data) pairs, in order....
+        std::vector<std::pair<uint64_t, size_t>> releases;
+        uint32_t bytesPerSecond = 0;
+        size_t receiveWindow = 0;
+        int64_t dropAfter = -1;
+        int64_t closeAt = -1;
+
+        size_t arrived = 0;
+        size_t consumed = 0;
+        uint64_t updatedAt = 0;
+        double carry = 0;
+        bool isClosed = false;
+
+        void advance();
+
+        size_t available() {
+            advance();
+            return arrived - consumed;
+        }
+
+        bool isOpen() {
+            advance();
+            return !isClosed;
+        }
+    };
+
+    void Connection::advance() {
+        uint64_t now = Clock::nowMicros();
+        if (isClosed) {
+            updatedAt = now;
+            return;
+        }
+
+        size_t released = 0;
+        for (const auto& [at, end] : releases) {
+            if (at <= now) {
+                released = end;
+            }
+        }
+
+        size_t limit = std::min(released, consumed + receiveWindow);
+        if (dropAfter >= 0) {
+            limit = std::min(limit, static_cast<size_t>(dropAfter));
+        }
+
+        if (bytesPerSecond == 0) {
+            arrived = std::max(arrived, limit);
+        } else if (arrived < limit) {
+            double credit = (static_cast<double>(now - updatedAt) * bytesPerSecond) / 1e6 + carry;
+            double whole = std::floor(credit);
+            if (arrived + whole >= limit) {
+                // the sender stalls on the window or an empty send buffer....
+                arrived = limit;
+                carry = 0;
+            } else {
+                arrived += static_cast<size_t>(whole);
+                carry = credit - whole;
+            }
+        } else {
+            carry = 0;
+        }
+        updatedAt = now;
+
+        if ((dropAfter >= 0 && arrived >= static_cast<size_t>(dropAfter) && arrived < data.size()) || (closeAt >= 0 && now >= static_cast<uint64_t>(closeAt))) {
+            isClosed = true;
+        }
+    }
+
+    namespace {
+        uint64_t threadCpuNanos() {
+            timespec now;
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+            return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+        }
+
+        const char* reasonPhrase(int status) {
+            switch (status) {
+                case 200:
+                    return "OK";
+                case 304:
+                    return "Not Modified";
+                case 401:
+                    return "Unauthorized";
+                case 404:
+                    return "Not Found";
+                case 429:
+                    return "Too Many Requests";
+                default:
+                    return "Status";
+            }
+        }
+
+        bool splitURL(const std::string& url, std::string& host, std::string& path, std::string& query) {
+            size_t scheme = url.find("://");
+            if (scheme == std::string::npos) {
+                return false;
+            }
+
+            std::string protocol = url.substr(0, scheme);
+            if (protocol != "http" && protocol != "https") {
+                return false;
+            }
+
+            size_t hostStart = scheme + 3;
+            size_t pathStart = url.find('/', hostStart);
+            host = url.substr(hostStart, pathStart == std::string::npos ? std::string::npos : pathStart - hostStart);
+            if (host.empty()) {
+                return false;
+            }
+
+            std::string target = pathStart == std::string::npos ? "/" : url.substr(pathStart);
+            size_t queryStart = target.find('?');
+            path = target.substr(0, queryStart);
+            query = queryStart == std::string::npos ? std::string() : target.substr(queryStart + 1);
+            return true;
+        }
+
+        std::string findHeader(const HeaderList& headers, const std::string& name) {
+            for (const auto& [key, value] : headers) {
+                if (strcasecmp(key.c_str(), name.c_str()) == 0) {
+                    return value;
+                }
+            }
+            return std::string();
+        }
+    }  // namespace
+
+    std::string HttpRequest::header(const std::string& name) const {
+        return findHeader(headers, name);
+    }
+
+    bool HttpRequest::hasHeader(const std::string& name) const {
+        for (const auto& header : headers) {
+            if (strcasecmp(header.first.c_str(), name.c_str()) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    HttpResponse HttpResponse::withStatus(int status, std::string body) {
+        HttpResponse response;
+        response.status = status;
+        response.body = std::move(body);
+        return response;
+    }
+
+    HttpResponse HttpResponse::json(int status, std::string body) {
+        return withStatus(status, std::move(body)).header("Content-Type", "application/json");
+    }
+
+    HttpResponse HttpResponse::binary(std::string body) {
+        return withStatus(200, std::move(body)).header("Content-Type", "application/octet-stream");
+    }
+
+    HttpResponse& HttpResponse::header(std::string name, std::string value) {
+        headers.emplace_back(std::move(name), std::move(value));
+        return *this;
+    }
+
+    MockServer& MockServer::instance() {
+        static MockServer server;
+        return server;
+    }
+
+    void MockServer::on(const std::string& path, Handler handler, const std::string& method) {
+        UntrackedScope untracked;
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (Route& route : _routes) {
+            if (route.path == path && route.method == method) {
+                route.handler = std::move(handler);
+                return;
+            }
+        }
+        _routes.push_back(Route{method, path, std::move(handler)});
+    }
+
+    void MockServer::setReachable(bool isReachable) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isReachable = isReachable;
+    }
+
+    void MockServer::setRoundTripMicros(uint64_t roundTripMicros) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _roundTripMicros = roundTripMicros;
+    }
+
+    HttpRequest MockServer::lastRequest() const {
+        UntrackedScope untracked;
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _log.empty() ? HttpRequest() : _log.back();
+    }
+
+    int MockServer::lastStatus() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _lastStatus;
+    }
+
+    std::vector<HttpRequest> MockServer::requestLog() const {
+        UntrackedScope untracked;
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _log;
+    }
+
+    MockServer::Stats MockServer::stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _stats;
+    }
+
+    void MockServer::resetStats() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stats = Stats();
+        _log.clear();
+    }
+
+    void MockServer::reset() {
+        UntrackedScope untracked;
+        std::lock_guard<std::mutex> lock(_mutex);
+        _routes.clear();
+        _log.clear();
+        _isReachable = true;
+        _roundTripMicros = 0;
+        _lastStatus = 0;
+        _stats = Stats();
+    }
+
+    bool MockServer::handle(const HttpRequest& request, HttpResponse& response) {
+        UntrackedScope untracked;
+        Handler handler;
+        bool isHead = request.method == "HEAD";
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_isReachable) {
+                return false;
+            }
+
+            if (_log.size() == MAX_LOGGED_REQUESTS) {
+                _log.erase(_log.begin());
+            }
+            _log.push_back(request);
+
+            const Route* fallback = nullptr;
+            for (const Route& route : _routes) {
+                if (route.path != request.path) {
+                    continue;
+                }
+                if (route.method == request.method) {
+                    handler = route.handler;
+                    break;
+                }
+                if (isHead && route.method == "GET") {
+                    fallback = &route;
+                }
+            }
+
+            if (!handler && fallback != nullptr) {
+                handler = fallback->handler;
+            }
+        }
+
+        // handlers run unlocked, they may block or call back into the server....
+        uint64_t startedAt = threadCpuNanos();
+        response = handler ? handler(request) : HttpResponse::withStatus(404);
+        uint64_t handlerNanos = threadCpuNanos() - startedAt;
+
+        if (response.contentLength == -2) {
+            response.contentLength = static_cast<int64_t>(response.body.size());
+        }
+
+        if (isHead) {
+            response.body.clear();
+            response.pushes.clear();
+        }
+
+        uint64_t bytesIn = request.method.size() + request.path.size() + request.query.size() + 12;
+        bytesIn += request.host.size() + 8;
+        for (const auto& [key, value] : request.headers) {
+            bytesIn += key.size() + value.size() + 4;
+        }
+
+        uint64_t bytesOut = 17 + strlen(reasonPhrase(response.status)) + response.body.size();
+        for (const auto& [key, value] : response.headers) {
+            bytesOut += key.size() + value.size() + 4;
+        }
+        if (response.contentLength >= 0) {
+            bytesOut += 18 + std::to_string(response.contentLength).size();
+        }
+        for (const HttpResponse::Push& push : response.pushes) {
+            bytesOut += push.data.size();
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        response.latencyMicros += _roundTripMicros;
+        _lastStatus = response.status;
+        _stats.requests++;
+        _stats.bytesIn += bytesIn;
+        _stats.bytesOut += bytesOut;
+        _stats.handlerCpuNanos += handlerNanos;
+        return true;
+    }
+}  // namespace Shim
+
+int WiFiClient::available() {
+    return _connection == nullptr ? 0 : static_cast<int>(_connection->available());
+}
+
+int WiFiClient::read() {
+    if (available() == 0) {
+        return -1;
+    }
+    return static_cast<uint8_t>(_connection->data[_connection->consumed++]);
+}
+
+int WiFiClient::peek() {
+    if (available() == 0) {
+        return -1;
+    }
+    return static_cast<uint8_t>(_connection->data[_connection->consumed]);
+}
+
+size_t WiFiClient::readBytes(uint8_t* buffer, size_t length) {
+    size_t received = 0;
+    uint32_t startedAt = millis();
+    while (received < length && _connection != nullptr) {
+        size_t ready = std::min(static_cast<size_t>(available()), length - received);
+        if (ready == 0) {
+            if (!_connection->isOpen() || millis() - startedAt >= _timeoutMs) {
+                break;
+            }
+            delay(1);
+            continue;
+        }
+
+        memcpy(buffer + received, _connection->data.data() + _connection->consumed, ready);
+        _connection->consumed += ready;
+        received += ready;
+    }
+    return received;
+}
+
+size_t WiFiClient::write(uint8_t value) {
+    (void)value;
+    return 1;
+}
+
+uint8_t WiFiClient::connected() {
+    if (_connection == nullptr) {
+        return 0;
+    }
+    return _connection->isOpen() || _connection->available() > 0;
+}
+
+void WiFiClient::stop() {
+    _connection.reset();
+}
+
+HTTPClient::~HTTPClient() {
+    end();
+}
+
+bool HTTPClient::begin(const String& url) {
+    Shim::UntrackedScope untracked;
+    end();
+
+    std::string host;
+    std::string path;
+    std::string query;
+    if (!Shim::splitURL(url.str(), host, path, query)) {
+        return false;
+    }
+
+    _url = url.str();
+    _isBegun = true;
+    return true;
+}
+
+bool HTTPClient::begin(WiFiClient& client, const String& url) {
+    (void)client;
+    return begin(url);
+}
+
+void HTTPClient::end() {
+    Shim::UntrackedScope untracked;
+    _isBegun = false;
+    _url.clear();
+    _requestHeaders.clear();
+    _responseHeaders.clear();
+    _size = -1;
+    _stream.stop();
+    _connection.reset();
+}
+
+bool HTTPClient::connected() {
+    return _connection != nullptr && _stream.connected();
+}
+
+void HTTPClient::useHTTP10(bool isEnabled) {
+    (void)isEnabled;
+}
+
+void HTTPClient::setReuse(bool isEnabled) {
+    (void)isEnabled;
+}
+
+void HTTPClient::setTimeout(uint16_t timeoutMs) {
+    _tcpTimeoutMs = timeoutMs;
+    _stream.setTimeout(timeoutMs);
+}
+
+void HTTPClient::setConnectTimeout(int32_t timeoutMs) {
+    _connectTimeoutMs = timeoutMs;
+}
+
+void HTTPClient::setFollowRedirects(followRedirects_t follow) {
+    _followRedirects = follow;
+}
+
+void HTTPClient::setUserAgent(const String& userAgent) {
+    Shim::UntrackedScope untracked;
+    _userAgent = userAgent.str();
+}
+
+void HTTPClient::addHeader(const char* name, const char* value) {
+    Shim::UntrackedScope untracked;
+    _requestHeaders.emplace_back(name, value);
+}
+
+void HTTPClient::addHeader(const String& name, const String& value, bool first, bool replace) {
+    (void)replace;
+    Shim::UntrackedScope untracked;
+    if (first) {
+        _requestHeaders.emplace(_requestHeaders.begin(), name.str(), value.str());
+    } else {
+        _requestHeaders.emplace_back(name.str(), value.str());
+    }
+}
+
+void HTTPClient::collectHeaders(const char* headerKeys[], const size_t headerKeysCount) {
+    Shim::UntrackedScope untracked;
+    _collectedKeys.assign(headerKeys, headerKeys + headerKeysCount);
+}
+
+String HTTPClient::header(const char* name) {
+    Shim::UntrackedScope untracked;
+    return String(Shim::findHeader(_responseHeaders, name));
+}
+
+bool HTTPClient::hasHeader(const char* name) {
+    for (const auto& header : _responseHeaders) {
+        if (strcasecmp(header.first.c_str(), name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int HTTPClient::headers() {
+    return static_cast<int>(_responseHeaders.size());
+}
+
+int HTTPClient::GET() {
+    return sendRequest("GET");
+}
+
+int HTTPClient::sendRequest(const char* method, const String& payload) {
+    (void)payload;
+    Shim::UntrackedScope untracked;
+    return _send(method, 0);
+}
+
+int HTTPClient::_send(const char* method, int redirects) {
+    if (!_isBegun) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    Shim::HttpRequest request;
+    request.method = method;
+    Shim::splitURL(_url, request.host, request.path, request.query);
+    request.headers = _requestHeaders;
+    request.headers.emplace_back("User-Agent", _userAgent);
+
+    Shim::HttpResponse response;
+    if (!Shim::MockServer::instance().handle(request, response)) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    uint64_t timeoutMicros = (static_cast<uint64_t>(_connectTimeoutMs) + _tcpTimeoutMs) * 1000;
+    if (response.latencyMicros > timeoutMicros) {
+        Shim::Clock::advanceMicros(timeoutMicros);
+        return HTTPC_ERROR_READ_TIMEOUT;
+    }
+    Shim::Clock::advanceMicros(response.latencyMicros);
+
+    bool isRedirect = response.status == 301 || response.status == 302 || response.status == 303 || response.status == 307 || response.status == 308;
+    std::string location = Shim::findHeader(response.headers, "Location");
+    if (isRedirect && _followRedirects != HTTPC_DISABLE_FOLLOW_REDIRECTS && !location.empty() && redirects < 10) {
+        _url = location;
+        return _send(method, redirects + 1);
+    }
+
+    _responseHeaders.clear();
+    for (const std::string& key : _collectedKeys) {
+        for (const auto& header : response.headers) {
+            if (strcasecmp(header.first.c_str(), key.c_str()) == 0) {
+                _responseHeaders.push_back(header);
+            }
+        }
+    }
+
+    auto connection = std::make_shared<Shim::Connection>();
+    uint64_t now = Shim::Clock::nowMicros();
+    connection->data = std::move(response.body);
+    connection->releases.emplace_back(now, connection->data.size());
+    for (const Shim::HttpResponse::Push& push : response.pushes) {
+        connection->data += push.data;
+        connection->releases.emplace_back(now + push.afterMicros, connection->data.size());
+    }
+    connection->bytesPerSecond = response.bytesPerSecond;
+    connection->receiveWindow = response.receiveWindow == 0 ? std::numeric_limits<size_t>::max() / 2 : response.receiveWindow;
+    connection->dropAfter = response.dropAfter;
+    connection->closeAt = response.closeAfterMicros < 0 ? -1 : static_cast<int64_t>(now) + response.closeAfterMicros;
+    connection->updatedAt = now;
+
+    _connection = connection;
+    _stream.attach(connection);
+    _size = response.contentLength > static_cast<int64_t>(std::numeric_limits<int>::max()) ? -1 : static_cast<int>(response.contentLength);
+    return response.status;
+}
+
+int HTTPClient::getSize() {
+    return _size;
+}
+
+WiFiClient* HTTPClient::getStreamPtr() {
+    return _connection == nullptr ? nullptr : &_stream;
+}
+
+WiFiClient& HTTPClient::getStream() {
+    return _stream;
+}
+
+String HTTPClient::getString() {
+    Shim::UntrackedScope untracked;
+    if (_connection == nullptr) {
+        return String();
+    }
+
+    // reads until Content-Length, or until the server closes the connection....
+    size_t expected = _size >= 0 ? static_cast<size_t>(_size) : std::numeric_limits<size_t>::max();
+    std::string body;
+    uint32_t lastReceivedAt = millis();
+    while (body.size() < expected) {
+        size_t ready = _connection->available();
+        if (ready == 0) {
+            if (!_connection->isOpen() || millis() - lastReceivedAt >= 5000) {
+                break;
+            }
+            delay(1);
+            continue;
+        }
+
+        ready = std::min(ready, expected - body.size());
+        body.append(_connection->data, _connection->consumed, ready);
+        _connection->consumed += ready;
+        lastReceivedAt = millis();
+    }
+    return String(std::move(body));
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+        case HTTPC_ERROR_CONNECTION_REFUSED:
+            return "connection refused";
+        case HTTPC_ERROR_CONNECTION_LOST:
+            return "connection lost";
+        case HTTPC_ERROR_READ_TIMEOUT:
+            return "read Timeout";
+        default:
+            return String();
+    }
+}
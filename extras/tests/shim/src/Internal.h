@@ -0,0 +1,10 @@
+// Hooks between the shim translation units, not for use by tests.
+#pragma once
+
+namespace Shim {
+    namespace Nvs {
+        void erase();
+    }  // namespace Nvs
+
+    void countRestart();
+}  // namespace Shim
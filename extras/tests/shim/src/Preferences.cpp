@@ -0,0 +1,117 @@
+#include <Preferences.h>
+#include <Shim.h>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "Internal.h"
+
+namespace {
+    // NVS_KEY_NAME_MAX_SIZE - 1
+    constexpr size_t MAX_NAME_LENGTH = 15;
+
+    using Entries = std::map<std::string, std::vector<uint8_t>>;
+
+    std::mutex nvsMutex;
+    std::map<std::string, Entries> nvs;
+
+    bool isValidName(const char* name) {
+        return name != nullptr && name[0] != '\0' && strlen(name) <= MAX_NAME_LENGTH;
+    }
+}  // namespace
+
+void Shim::Nvs::erase() {
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    nvs.clear();
+}
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+    (void)partitionLabel;
+    Shim::UntrackedScope untracked;
+    if (_isOpen || !isValidName(name)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    // nvs_open() in read-only mode fails with ESP_ERR_NVS_NOT_FOUND until the
+    // namespace has been created by a read-write open....
+    if (readOnly && nvs.find(name) == nvs.end()) {
+        return false;
+    }
+
+    nvs[name];
+    _namespace = name;
+    _isOpen = true;
+    _isReadOnly = readOnly;
+    return true;
+}
+
+void Preferences::end() {
+    _isOpen = false;
+}
+
+bool Preferences::clear() {
+    if (!_isOpen || _isReadOnly) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    nvs[_namespace].clear();
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!_isOpen || _isReadOnly || !isValidName(key)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    return nvs[_namespace].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    if (!_isOpen || !isValidName(key)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    return nvs[_namespace].count(key) > 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    Shim::UntrackedScope untracked;
+    if (!_isOpen || _isReadOnly || !isValidName(key) || value == nullptr || length == 0) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    nvs[_namespace][key].assign(bytes, bytes + length);
+    return length;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!_isOpen || !isValidName(key)) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    const Entries& entries = nvs[_namespace];
+    auto entry = entries.find(key);
+    return entry == entries.end() ? 0 : entry->second.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength) {
+    if (!_isOpen || !isValidName(key) || buffer == nullptr) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    const Entries& entries = nvs[_namespace];
+    auto entry = entries.find(key);
+    if (entry == entries.end() || entry->second.size() > maxLength) {
+        return 0;
+    }
+
+    memcpy(buffer, entry->second.data(), entry->second.size());
+    return entry->second.size();
+}
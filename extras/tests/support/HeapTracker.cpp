@@ -0,0 +1,115 @@
+#include "HeapTracker.h"
+#include <Shim.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    // Sits in front of every block, keeps the block 16-byte aligned.
+    struct alignas(16) BlockHeader {
+        size_t size;
+        uint32_t epoch;
+    };
+
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> allocatedBytes{0};
+    std::atomic<int64_t> liveBytes{0};
+    std::atomic<int64_t> peakBytes{0};
+    // Blocks from an earlier epoch were allocated before the last reset()....
+    std::atomic<uint32_t> epoch{1};
+
+    void* allocate(size_t size) {
+        BlockHeader* header = static_cast<BlockHeader*>(malloc(sizeof(BlockHeader) + size));
+        if (header == nullptr) {
+            return nullptr;
+        }
+
+        header->size = size;
+        header->epoch = 0;
+        if (Shim::untrackedDepth == 0) {
+            header->epoch = epoch.load();
+            allocations.fetch_add(1);
+            allocatedBytes.fetch_add(size);
+            int64_t live = liveBytes.fetch_add(static_cast<int64_t>(size)) + static_cast<int64_t>(size);
+            int64_t peak = peakBytes.load();
+            while (live > peak && !peakBytes.compare_exchange_weak(peak, live)) {
+            }
+        }
+        return header + 1;
+    }
+
+    void release(void* block) {
+        if (block == nullptr) {
+            return;
+        }
+
+        BlockHeader* header = static_cast<BlockHeader*>(block) - 1;
+        if (header->epoch != 0 && header->epoch == epoch.load()) {
+            liveBytes.fetch_sub(static_cast<int64_t>(header->size));
+        }
+        free(header);
+    }
+}  // namespace
+
+namespace HeapTracker {
+    void reset() {
+        epoch.fetch_add(1);
+        allocations.store(0);
+        allocatedBytes.store(0);
+        liveBytes.store(0);
+        peakBytes.store(0);
+    }
+
+    Stats stats() {
+        Stats stats;
+        stats.allocations = allocations.load();
+        stats.allocatedBytes = allocatedBytes.load();
+        stats.liveBytes = liveBytes.load();
+        stats.peakBytes = peakBytes.load();
+        return stats;
+    }
+}  // namespace HeapTracker
+
+void* operator new(size_t size) {
+    void* block = allocate(size);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void* block) noexcept {
+    release(block);
+}
+
+void operator delete[](void* block) noexcept {
+    release(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    release(block);
+}
+
+void operator delete[](void* block, size_t) noexcept {
+    release(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept {
+    release(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept {
+    release(block);
+}
@@ -0,0 +1,24 @@
+// Counts heap allocations made by the library, through replacements of the
+// global operator new and delete in HeapTracker.cpp. Link that file into the
+// executables that use this header. Allocations inside the shim (see
+// Shim::UntrackedScope) are left out.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace HeapTracker {
+    struct Stats {
+        uint64_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+        // Bytes live right now and the highest that got since reset().
+        int64_t liveBytes = 0;
+        int64_t peakBytes = 0;
+    };
+
+    // Zeroes the counters; blocks allocated before are no longer counted
+    // when freed.
+    void reset();
+
+    Stats stats();
+}  // namespace HeapTracker
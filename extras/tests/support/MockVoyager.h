@@ -0,0 +1,141 @@
+// Routes of the Voyager backend on the shim's MockServer, shared by the host
+// tests and the fleet load generator.
+#pragma once
+
+#include <MockServer.h>
+#include <Shim.h>
+#include <string>
+#include <vector>
+
+namespace MockVoyager {
+    constexpr const char* BASE_URL = "https://voyager.test";
+    constexpr const char* LATEST_RELEASE_PATH = "/internal/api/v1/releases/latest";
+    constexpr const char* PROJECT_ID = "project-1";
+    constexpr const char* API_KEY = "key-1";
+
+    struct Release {
+        std::string version = "1.1.0";
+        std::string id = "release-1";
+        std::string status = "published";
+        std::vector<uint8_t> image = Shim::makeFirmwareImage(256 * 1024, 7);
+        // Optional x-signature and x-MD5 headers of the firmware response.
+        std::string signature;
+        std::string md5;
+
+        std::string downloadPath() const { return "/firmware/" + id + ".bin"; }
+
+        std::string downloadURL() const { return std::string(BASE_URL) + downloadPath(); }
+    };
+
+    inline std::string releaseJson(const Release& release) {
+        return std::string("{\"release\":{") +
+               "\"version\":\"" + release.version + "\"," +
+               "\"id\":\"" + release.id + "\"," +
+               "\"changeLog\":\"Bug fixes\"," +
+               "\"releasedAt\":\"2026-10-01T10:00:00Z\"," +
+               "\"status\":\"" + release.status + "\"," +
+               "\"artifact\":{" +
+               "\"hash\":\"" + Shim::md5Hex(release.image) + "\"," +
+               "\"size\":" + std::to_string(release.image.size()) + "," +
+               "\"prettySize\":\"" + std::to_string(release.image.size() / 1024) + " KB\"," +
+               "\"downloadURL\":\"" + release.downloadURL() + "\"}}}";
+    }
+
+    namespace MsgPack {
+        inline void map(std::string& out, size_t count) {
+            out += static_cast<char>(0x80 | count);
+        }
+
+        inline void string(std::string& out, const std::string& value) {
+            if (value.size() < 32) {
+                out += static_cast<char>(0xA0 | value.size());
+            } else if (value.size() < 256) {
+                out += static_cast<char>(0xD9);
+                out += static_cast<char>(value.size());
+            } else {
+                out += static_cast<char>(0xDA);
+                out += static_cast<char>(value.size() >> 8);
+                out += static_cast<char>(value.size());
+            }
+            out += value;
+        }
+
+        inline void uint(std::string& out, uint32_t value) {
+            if (value < 128) {
+                out += static_cast<char>(value);
+                return;
+            }
+            out += static_cast<char>(0xCE);
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                out += static_cast<char>(value >> shift);
+            }
+        }
+    }  // namespace MsgPack
+
+    // Same document as releaseJson(), MessagePack encoded.
+    inline std::string releaseMsgPack(const Release& release) {
+        std::string out;
+        MsgPack::map(out, 1);
+        MsgPack::string(out, "release");
+        MsgPack::map(out, 6);
+        MsgPack::string(out, "version");
+        MsgPack::string(out, release.version);
+        MsgPack::string(out, "id");
+        MsgPack::string(out, release.id);
+        MsgPack::string(out, "changeLog");
+        MsgPack::string(out, "Bug fixes");
+        MsgPack::string(out, "releasedAt");
+        MsgPack::string(out, "2026-10-01T10:00:00Z");
+        MsgPack::string(out, "status");
+        MsgPack::string(out, release.status);
+        MsgPack::string(out, "artifact");
+        MsgPack::map(out, 4);
+        MsgPack::string(out, "hash");
+        MsgPack::string(out, Shim::md5Hex(release.image));
+        MsgPack::string(out, "size");
+        MsgPack::uint(out, static_cast<uint32_t>(release.image.size()));
+        MsgPack::string(out, "prettySize");
+        MsgPack::string(out, std::to_string(release.image.size() / 1024) + " KB");
+        MsgPack::string(out, "downloadURL");
+        MsgPack::string(out, release.downloadURL());
+        return out;
+    }
+
+    inline bool isAuthorized(const Shim::HttpRequest& request) {
+        return request.header("x-project-id") == PROJECT_ID && request.header("x-api-key") == API_KEY;
+    }
+
+    // Serves the release metadata and the image, both behind the project
+    // credentials. The metadata is MessagePack when the client accepts it,
+    // the image goes out at bytesPerSecond, 0 is unlimited.
+    inline void serve(const Release& release, uint32_t bytesPerSecond = 0) {
+        Shim::MockServer& server = Shim::MockServer::instance();
+
+        server.on(LATEST_RELEASE_PATH, [release](const Shim::HttpRequest& request) {
+            if (!isAuthorized(request)) {
+                return Shim::HttpResponse::json(401, "{\"message\":\"Unauthorized\"}");
+            }
+            if (request.header("Accept").find("application/msgpack") != std::string::npos) {
+                Shim::HttpResponse response = Shim::HttpResponse::withStatus(200, releaseMsgPack(release));
+                return response.header("Content-Type", "application/msgpack");
+            }
+            return Shim::HttpResponse::json(200, releaseJson(release));
+        });
+
+        server.on(release.downloadPath(), [release, bytesPerSecond](const Shim::HttpRequest& request) {
+            if (!isAuthorized(request)) {
+                return Shim::HttpResponse::withStatus(401);
+            }
+
+            Shim::HttpResponse response = Shim::HttpResponse::binary(std::string(release.image.begin(), release.image.end()));
+            response.bytesPerSecond = bytesPerSecond;
+            if (!release.signature.empty()) {
+                response.header("x-signature", release.signature);
+            }
+            if (!release.md5.empty()) {
+                response.header("x-MD5", release.md5);
+            }
+            return response;
+        });
+    }
+}  // namespace MockVoyager
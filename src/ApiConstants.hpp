@@ -1,13 +1,50 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+
 namespace __VoyagerApi__ {
-    namespace Endpoints {
-        String LATEST_RELEASE = "/internal/api/v1/releases/latest";
-    }  // namespace Endpoints
+    namespace Helpers {
+        // Joins string literals at compile time, the result lives in flash
+        // instead of being assembled on the heap at static-init or per request.
+        template <size_t N_Left, size_t N_Right>
+        constexpr std::array<char, N_Left + N_Right - 1> concat(const char (&left)[N_Left], const char (&right)[N_Right]) {
+            std::array<char, N_Left + N_Right - 1> result{};
+            for (size_t i = 0; i < N_Left - 1; ++i) {
+                result[i] = left[i];
+            }
+            for (size_t i = 0; i < N_Right; ++i) {
+                result[N_Left - 1 + i] = right[i];
+            }
+            return result;
+        }
+
+        template <size_t N_Left, size_t N_Right>
+        constexpr bool equals(const std::array<char, N_Left>& left, const char (&right)[N_Right]) {
+            if (N_Left != N_Right) {
+                return false;
+            }
+            for (size_t i = 0; i < N_Left; ++i) {
+                if (left[i] != right[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }  // namespace Helpers
     namespace QueryParams {
-        String PRODUCTION_CHANNEL = "?channel=production";
-        String STAGING_CHANNEL = "?channel=staging";
+        inline constexpr char PRODUCTION_CHANNEL[] = "?channel=production";
+        inline constexpr char STAGING_CHANNEL[] = "?channel=staging";
     }  // namespace QueryParams
+    namespace Endpoints {
+        inline constexpr char LATEST_RELEASE[] = "/internal/api/v1/releases/latest";
+        inline constexpr auto LATEST_PRODUCTION_RELEASE = Helpers::concat(LATEST_RELEASE, QueryParams::PRODUCTION_CHANNEL);
+        inline constexpr auto LATEST_STAGING_RELEASE = Helpers::concat(LATEST_RELEASE, QueryParams::STAGING_CHANNEL);
+
+        // a broken endpoint fails the build instead of the first poll....
+        static_assert(Helpers::equals(LATEST_PRODUCTION_RELEASE, "/internal/api/v1/releases/latest?channel=production"), "production endpoint");
+        static_assert(Helpers::equals(LATEST_STAGING_RELEASE, "/internal/api/v1/releases/latest?channel=staging"), "staging endpoint");
+    }  // namespace Endpoints
     namespace Headers {
         namespace Keys {
             constexpr const char* X_API_KEY = "x-api-key";
@@ -0,0 +1,246 @@
+/******************************************************************************
+ * MIT License
+ *
+ * @headerfile [HealthCheck.hpp]
+ *
+ * @description: Post-update boot health check, commits a freshly installed
+ * image or rolls back to the previous one.
+ *
+ * @copyright (c) 2025
+ * @author: fahadziakhan9@gmail.com (Fahad Zia Khan / Mediocre9)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef MEDIOCRE9_VOYAGER_OTA_HEALTH_CHECK_H
+#define MEDIOCRE9_VOYAGER_OTA_HEALTH_CHECK_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <Update.h>
+#include <WString.h>
+#include <esp_ota_ops.h>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include "ReleaseCache.hpp"
+
+namespace Voyager {
+    enum class BootState : uint8_t {
+        NORMAL,
+        PENDING,
+        COMMITTED,
+        ROLLED_BACK,
+    };
+
+    // Persisted across reboots so the outcome of the last update is known
+    // before any network I/O. Versions are stored the way ReleaseRecord
+    // stores them, a long one as its head and a hash.
+    struct BootRecord {
+        BootState state = BootState::NORMAL;
+        uint8_t bootAttempts = 0;
+        char version[24] = {};
+        char failedVersion[24] = {};
+        // flash address of the partition the pending image was written to....
+        uint32_t partitionAddress = 0;
+    };
+
+    using HealthProbe = std::function<bool()>;
+
+    class HealthCheck {
+    public:
+        explicit HealthCheck(const char* storageNamespace = "voyager-boot");
+
+        HealthCheck(const HealthCheck&) = delete;
+        HealthCheck& operator=(const HealthCheck&) = delete;
+
+        // Loads the boot record, call it early in setup().
+        bool begin();
+
+        // Probes are polled in order until they return true, all of them
+        // sharing the time budget given to run().
+        void addProbe(const char* name, HealthProbe probe);
+
+        // Number of boots a pending image gets before it is rolled back
+        // without running the probes, e.g. after watchdog resets.
+        void setMaxBootAttempts(uint8_t maxBootAttempts);
+
+        // Does nothing unless an update is pending. Commits the new image when
+        // every probe passes within the budget, otherwise rolls back and reboots.
+        // When another partition than the pending one is running, the
+        // bootloader already gave up on the image and it is recorded as
+        // rolled back without probing.
+        BootState run(uint32_t budgetMs);
+
+        // Called by OTA right before rebooting into a freshly written image,
+        // once it has been made the boot partition.
+        void markPending(const String& version);
+
+        [[nodiscard]] const BootRecord& getRecord() const;
+
+        [[nodiscard]] bool isFailedVersion(const String& version) const;
+
+    private:
+        void _commit();
+
+        void _rollback(const char* reason);
+
+        bool _persist();
+
+    private:
+        static constexpr const char* STORAGE_KEY = "record";
+
+        const char* _storageNamespace;
+        BootRecord _record;
+        std::vector<std::pair<const char*, HealthProbe>> _probes;
+        uint8_t _maxBootAttempts = 3;
+    };
+}  // namespace Voyager
+
+inline Voyager::HealthCheck::HealthCheck(const char* storageNamespace) : _storageNamespace(storageNamespace) {}
+
+inline bool Voyager::HealthCheck::begin() {
+    // read-write, a read-only open fails until the namespace exists....
+    Preferences preferences;
+    if (!preferences.begin(_storageNamespace, false)) {
+        return false;
+    }
+
+    if (preferences.getBytesLength(STORAGE_KEY) == sizeof(_record)) {
+        preferences.getBytes(STORAGE_KEY, &_record, sizeof(_record));
+    }
+    preferences.end();
+    return true;
+}
+
+inline void Voyager::HealthCheck::addProbe(const char* name, HealthProbe probe) {
+    _probes.emplace_back(name, probe);
+}
+
+inline void Voyager::HealthCheck::setMaxBootAttempts(uint8_t maxBootAttempts) {
+    _maxBootAttempts = maxBootAttempts;
+}
+
+inline Voyager::BootState Voyager::HealthCheck::run(uint32_t budgetMs) {
+    if (_record.state != BootState::PENDING) {
+        return _record.state;
+    }
+
+    // the new image never got to run (e.g. it failed validation at boot or
+    // the bootloader reverted it), so there is nothing to probe or roll back....
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    if (running == nullptr || running->address != _record.partitionAddress) {
+        Serial.printf("VOYAGER_OTA Image %s is not running, recording it as rolled back!\n", _record.version);
+        _record.state = BootState::ROLLED_BACK;
+        memcpy(_record.failedVersion, _record.version, sizeof(_record.failedVersion));
+        _persist();
+        return _record.state;
+    }
+
+    // counted before probing, so a probe that hangs or crashes still uses up an attempt....
+    _record.bootAttempts++;
+    _persist();
+
+    if (_record.bootAttempts > _maxBootAttempts) {
+        _rollback("boot attempts exhausted");
+        return _record.state;
+    }
+
+    uint32_t startedAt = millis();
+    for (const auto& [name, probe] : _probes) {
+        while (!probe()) {
+            if (millis() - startedAt > budgetMs) {
+                _rollback(name);
+                return _record.state;
+            }
+            delay(10);
+        }
+    }
+
+    _commit();
+    return _record.state;
+}
+
+inline void Voyager::HealthCheck::markPending(const String& version) {
+    _record.state = BootState::PENDING;
+    _record.bootAttempts = 0;
+    ReleaseCacheHelper::copy(_record.version, sizeof(_record.version), version);
+
+    const esp_partition_t* target = esp_ota_get_boot_partition();
+    _record.partitionAddress = target != nullptr ? target->address : 0;
+    _persist();
+}
+
+inline const Voyager::BootRecord& Voyager::HealthCheck::getRecord() const {
+    return _record;
+}
+
+inline bool Voyager::HealthCheck::isFailedVersion(const String& version) const {
+    if (_record.failedVersion[0] == '\0') {
+        return false;
+    }
+
+    // compared in stored form, the record may hold a shortened version....
+    char stored[sizeof(_record.failedVersion)];
+    ReleaseCacheHelper::copy(stored, sizeof(stored), version);
+    return strcmp(_record.failedVersion, stored) == 0;
+}
+
+inline void Voyager::HealthCheck::_commit() {
+    _record.state = BootState::COMMITTED;
+    _persist();
+
+    // only meaningful when the bootloader has app rollback enabled....
+    esp_ota_mark_app_valid_cancel_rollback();
+    Serial.printf("VOYAGER_OTA Image %s committed!\n", _record.version);
+}
+
+inline void Voyager::HealthCheck::_rollback(const char* reason) {
+    Serial.printf("VOYAGER_OTA Health check failed (%s), rolling back image %s!\n", reason, _record.version);
+
+    // persisted first, the device does not come back from the calls below....
+    _record.state = BootState::ROLLED_BACK;
+    memcpy(_record.failedVersion, _record.version, sizeof(_record.failedVersion));
+    _persist();
+
+    esp_ota_img_states_t imageState;
+    if (esp_ota_get_state_partition(esp_ota_get_running_partition(), &imageState) == ESP_OK && imageState == ESP_OTA_IMG_PENDING_VERIFY) {
+        esp_ota_mark_app_invalid_rollback_and_reboot();
+    }
+
+    if (Update.canRollBack() && Update.rollBack()) {
+        ESP.restart();
+    }
+
+    Serial.println("VOYAGER_OTA No previous image to roll back to!");
+}
+
+inline bool Voyager::HealthCheck::_persist() {
+    Preferences preferences;
+    if (!preferences.begin(_storageNamespace, false)) {
+        Serial.println("VOYAGER_OTA Boot record could not be persisted!");
+        return false;
+    }
+
+    size_t written = preferences.putBytes(STORAGE_KEY, &_record, sizeof(_record));
+    preferences.end();
+    return written == sizeof(_record);
+}
+#endif
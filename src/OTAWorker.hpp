@@ -0,0 +1,398 @@
+/******************************************************************************
+ * MIT License
+ *
+ * @headerfile [OTAWorker.hpp]
+ *
+ * @description: Optional FreeRTOS worker task that owns an OTA instance and
+ * runs all of its network and flash I/O away from the application tasks.
+ *
+ * @copyright (c) 2025
+ * @author: fahadziakhan9@gmail.com (Fahad Zia Khan / Mediocre9)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef MEDIOCRE9_VOYAGER_OTA_WORKER_H
+#define MEDIOCRE9_VOYAGER_OTA_WORKER_H
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include "VoyagerOTA.hpp"
+
+namespace Voyager {
+    enum class WorkerCommand : uint8_t {
+        CHECK,
+        UPDATE,
+        CANCEL,
+        STOP,
+    };
+
+    enum class WorkerEventType : uint8_t {
+        RELEASE_AVAILABLE,
+        UP_TO_DATE,
+        CHECK_FAILED,
+        UPDATE_STARTED,
+        UPDATE_FINISHED,
+        UPDATE_FAILED,
+        CANCELLED,
+        EVENTS_DROPPED,
+    };
+
+    struct WorkerEvent {
+        WorkerEventType type;
+        // Error code of UPDATE_FAILED as passed to onError, e.g.
+        // UpdateError::SIGNATURE_INVALID or an HTTPUpdate error, 0 otherwise.
+        int code = 0;
+        char version[32] = {};
+    };
+
+    struct WorkerConfig {
+        BaseType_t core = 0;
+        UBaseType_t priority = 1;
+        uint32_t stackSize = 8192;
+        UBaseType_t commandQueueLength = 4;
+    };
+
+    // Single producer / single consumer ring buffer. The worker task is the
+    // only producer and the application task polling events the only consumer.
+    template <typename T, size_t N>
+    class SpscQueue {
+        static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two!");
+
+    public:
+        bool push(const T& item) {
+            size_t head = _head.load(std::memory_order_relaxed);
+            if (head - _tail.load(std::memory_order_acquire) == N) {
+                return false;
+            }
+            _items[head & (N - 1)] = item;
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(T& item) {
+            size_t tail = _tail.load(std::memory_order_relaxed);
+            if (tail == _head.load(std::memory_order_acquire)) {
+                return false;
+            }
+            item = _items[tail & (N - 1)];
+            _tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        std::array<T, N> _items{};
+        std::atomic<size_t> _head{0};
+        std::atomic<size_t> _tail{0};
+    };
+
+    template <typename T_ResponseData = Voyager::HTTPResponseData, typename T_PayloadModel = Voyager::DefaultReleaseModel, size_t EVENT_QUEUE_LENGTH = 8>
+    class OTAWorker {
+    public:
+        using Client = Voyager::OTA<T_ResponseData, T_PayloadModel>;
+
+        template <typename... T_Args>
+        explicit OTAWorker(T_Args&&... args) : _ota(std::forward<T_Args>(args)...) {}
+
+        OTAWorker(const OTAWorker&) = delete;
+        OTAWorker& operator=(const OTAWorker&) = delete;
+
+        // Configure the client through this reference before begin() only. Once
+        // the task is running the worker is its sole user.
+        [[nodiscard]] Client& client();
+
+        void setDownloadHeaders(std::vector<Header> headers);
+
+        bool begin(const WorkerConfig& config = WorkerConfig());
+
+        bool post(WorkerCommand command, TickType_t timeout = 0);
+
+        [[nodiscard]] bool poll(WorkerEvent& event);
+
+        [[nodiscard]] bool isRunning() const;
+
+        void end();
+
+        ~OTAWorker();
+
+    private:
+        // Queue item, stamped with the cancel generation current when posted.
+        struct Message {
+            WorkerCommand command;
+            uint32_t generation;
+        };
+
+        static void _taskEntry(void* parameter);
+
+        void _run();
+
+        void _check();
+
+        void _update(uint32_t generation);
+
+        // Drops pending work after a cancel, returns true when a STOP was
+        // among it.
+        [[nodiscard]] bool _drainCommands();
+
+        void _emit(WorkerEventType type, int code = 0);
+
+    private:
+        Client _ota;
+        std::vector<Header> _downloadHeaders;
+        std::optional<T_PayloadModel> _release;
+        CancellationToken _cancellationToken;
+
+        QueueHandle_t _commands = nullptr;
+        TaskHandle_t _task = nullptr;
+        SpscQueue<WorkerEvent, EVENT_QUEUE_LENGTH> _events;
+        std::atomic<bool> _running{false};
+        std::atomic<bool> _eventsDropped{false};
+        std::atomic<uint32_t> _cancelGeneration{0};
+    };
+}  // namespace Voyager
+
+template <typename T_ResponseData, typename T_PayloadModel, size_t EVENT_QUEUE_LENGTH>
+typename Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::Client& Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::client() {
+    return _ota;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, size_t EVENT_QUEUE_LENGTH>
+void Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::setDownloadHeaders(std::vector<Header> headers) {
+    _downloadHeaders = headers;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, size_t EVENT_QUEUE_LENGTH>
+bool Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::begin(const WorkerConfig& config) {
+    if (_running) {
+        return true;
+    }
+
+    // a worker that stopped on its own left its queue behind....
+    if (_commands != nullptr) {
+        vQueueDelete(_commands);
+        _commands = nullptr;
+    }
+
+    _commands = xQueueCreate(config.commandQueueLength, sizeof(Message));
+    if (_commands == nullptr) {
+        Serial.println("VOYAGER_OTA Worker command queue allocation failed!");
+        return false;
+    }
+
+    _running = true;
+    BaseType_t isCreated = xTaskCreatePinnedToCore(&OTAWorker::_taskEntry,
+                                                   "voyager-ota",
+                                                   config.stackSize,
+                                                   this,
+                                                   config.priority,
+                                                   &_task,
+                                                   config.core);
+    if (isCreated != pdPASS) {
+        Serial.println("VOYAGER_OTA Worker task creation failed!");
+        _running = false;
+        vQueueDelete(_commands);
+        _commands = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, size_t EVENT_QUEUE_LENGTH>
+bool Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::post(WorkerCommand command, TickType_t timeout) {
+    if (!_running) {
+        return false;
+    }
+
+    // cancel and stop jump the queue so they are not stuck behind pending work,
+    // and abort a running download right away. The generation is bumped first,
+    // so an update dequeued before the cancel can tell it was overtaken....
+    if (command == WorkerCommand::CANCEL || command == WorkerCommand::STOP) {
+        Message message{command, _cancelGeneration.fetch_add(1) + 1};
+        _cancellationToken.cancel();
+        return xQueueSendToFront(_commands, &message, timeout) == pdPASS;
+    }
+
+    Message message{command, _cancelGeneration.load()};
+    return xQueueSendToBack(_commands, &message, timeout) == pdPASS;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, size_t EVENT_QUEUE_LENGTH>
+bool Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::poll(WorkerEvent& event) {
+    if (_events.pop(event)) {
+        return true;
+    }
+
+    if (_eventsDropped.exchange(false)) {
+        event = WorkerEvent{WorkerEventType::EVENTS_DROPPED};
+        return true;
+    }
+
+    return false;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, size_t EVENT_QUEUE_LENGTH>
+bool Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::isRunning() const {
+    return _running;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, size_t EVENT_QUEUE_LENGTH>
+void Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::end() {
+    if (_commands == nullptr) {
+        return;
+    }
+
+    if (_running) {
+        post(WorkerCommand::STOP, portMAX_DELAY);
+        while (_running) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+    }
+
+    vQueueDelete(_commands);
+    _commands = nullptr;
+    _task = nullptr;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, size_t EVENT_QUEUE_LENGTH>
+Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::~OTAWorker() {
+    end();
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, size_t EVENT_QUEUE_LENGTH>
+void Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::_taskEntry(void* parameter) {
+    static_cast<OTAWorker*>(parameter)->_run();
+    vTaskDelete(nullptr);
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, size_t EVENT_QUEUE_LENGTH>
+void Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::_run() {
+    Message message;
+    while (xQueueReceive(_commands, &message, portMAX_DELAY) == pdPASS) {
+        switch (message.command) {
+            case WorkerCommand::CHECK: {
+                _check();
+            } break;
+
+            case WorkerCommand::UPDATE: {
+                _update(message.generation);
+            } break;
+
+            case WorkerCommand::CANCEL: {
+                bool isStopRequested = _drainCommands();
+                _release.reset();
+                _emit(WorkerEventType::CANCELLED);
+                if (isStopRequested) {
+                    _running = false;
+                    return;
+                }
+            } break;
+
+            case WorkerCommand::STOP: {
+                _running = false;
+                return;
+            }
+        }
+    }
+
+    _running = false;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, size_t EVENT_QUEUE_LENGTH>
+bool Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::_drainCommands() {
+    // a STOP posted around the cancel must survive it, or end() waits forever....
+    bool isStopRequested = false;
+    Message message;
+    while (xQueueReceive(_commands, &message, 0) == pdPASS) {
+        isStopRequested = isStopRequested || message.command == WorkerCommand::STOP;
+    }
+    return isStopRequested;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, size_t EVENT_QUEUE_LENGTH>
+void Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::_check() {
+    _release = _ota.fetchLatestRelease();
+    if (!_release) {
+        _emit(WorkerEventType::CHECK_FAILED);
+        return;
+    }
+
+    if (_ota.isNewVersion(_release->version)) {
+        _emit(WorkerEventType::RELEASE_AVAILABLE);
+    } else {
+        _emit(WorkerEventType::UP_TO_DATE);
+        _release.reset();
+    }
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, size_t EVENT_QUEUE_LENGTH>
+void Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::_update(uint32_t generation) {
+    if (!_release) {
+        _emit(WorkerEventType::UPDATE_FAILED);
+        return;
+    }
+
+    // the token is reset before the generation is compared, so a cancel
+    // landing in between is either seen here or left set on the token....
+    _cancellationToken.reset();
+    if (_cancelGeneration.load() != generation) {
+        _cancellationToken.cancel();
+        return;
+    }
+
+    _emit(WorkerEventType::UPDATE_STARTED);
+    _ota.setDownloadURL(_release->downloadURL, _downloadHeaders);
+    _ota.performUpdate(_cancellationToken);
+
+    if (_cancellationToken.isCancelled()) {
+        return;
+    }
+
+    switch (_ota.getLastUpdateResult()) {
+        case HTTP_UPDATE_OK: {
+            _emit(WorkerEventType::UPDATE_FINISHED);
+        } break;
+
+        // the server answered 304 for the image....
+        case HTTP_UPDATE_NO_UPDATES: {
+            _emit(WorkerEventType::UP_TO_DATE);
+        } break;
+
+        default: {
+            _emit(WorkerEventType::UPDATE_FAILED, _ota.getLastError());
+        } break;
+    }
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, size_t EVENT_QUEUE_LENGTH>
+void Voyager::OTAWorker<T_ResponseData, T_PayloadModel, EVENT_QUEUE_LENGTH>::_emit(WorkerEventType type, int code) {
+    WorkerEvent event{type, code};
+    if (_release) {
+        strncpy(event.version, _release->version.c_str(), sizeof(event.version) - 1);
+    }
+
+    if (!_events.push(event)) {
+        _eventsDropped = true;
+    }
+}
+#endif
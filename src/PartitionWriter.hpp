@@ -0,0 +1,317 @@
+/******************************************************************************
+ * MIT License
+ *
+ * @headerfile [PartitionWriter.hpp]
+ *
+ * @description: OTA partition writer that erases flash sectors ahead of the
+ * write cursor while the network is idle.
+ *
+ * @copyright (c) 2025
+ * @author: fahadziakhan9@gmail.com (Fahad Zia Khan / Mediocre9)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef MEDIOCRE9_VOYAGER_OTA_PARTITION_WRITER_H
+#define MEDIOCRE9_VOYAGER_OTA_PARTITION_WRITER_H
+
+#include <Arduino.h>
+#include <MD5Builder.h>
+#include <esp_app_format.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace Voyager {
+    namespace PartitionError {
+        constexpr int NO_PARTITION = -210;
+        constexpr int TOO_LARGE = -211;
+        constexpr int ERASE_FAILED = -212;
+        constexpr int WRITE_FAILED = -213;
+        constexpr int MAGIC_MISMATCH = -214;
+        constexpr int INCOMPLETE = -215;
+        constexpr int ACTIVATE_FAILED = -216;
+        constexpr int MD5_MISMATCH = -217;
+    }  // namespace PartitionError
+
+    // Drop-in for the subset of UpdateClass used by the download loop. Sectors
+    // are erased by eraseAhead() during network idle gaps; write() still has
+    // to erase, and wait on it, whenever the network left no gap to do so.
+    // On encrypted flash, writes are buffered to whole 16 byte blocks. As in
+    // UpdateClass, the first block of the image is held back and only flashed
+    // by end() once the image checks out, so an interrupted or corrupt
+    // download never leaves an image with a valid header behind.
+    class PartitionWriter {
+    public:
+        static constexpr size_t SECTOR_SIZE = 4096;
+        static constexpr size_t ERASE_AHEAD_WINDOW = 16 * SECTOR_SIZE;
+        // esp_partition_write() on an encrypted partition needs offset and
+        // length aligned to the AES block....
+        static constexpr size_t ENCRYPTED_BLOCK_SIZE = 16;
+
+        bool begin(size_t size);
+
+        // Expected MD5 of the whole image as 32 hex digits, checked in end().
+        bool setMD5(const char* expectedMD5);
+
+        size_t write(uint8_t* data, size_t length);
+
+        // Erases the next sector past the write cursor, within the image size
+        // and the erase-ahead window. Returns false when there is nothing to do.
+        bool eraseAhead();
+
+        // Sectors write() had to erase itself since begin(), each one a stall
+        // of the receive loop.
+        [[nodiscard]] size_t getStalledErases() const;
+
+        // Verifies the image and makes the partition the next boot target.
+        bool end();
+
+        void abort();
+
+        [[nodiscard]] int getError() const;
+
+    private:
+        bool _eraseUntil(size_t offset);
+
+        bool _flash(const uint8_t* data, size_t length);
+
+    private:
+        const esp_partition_t* _partition = nullptr;
+        size_t _size = 0;
+        // bytes accepted by write() and bytes on the flash, these differ by
+        // the pending tail block on encrypted flash....
+        size_t _written = 0;
+        size_t _flashed = 0;
+        size_t _erasedUntil = 0;
+        size_t _stalledErases = 0;
+        uint8_t _pending[ENCRYPTED_BLOCK_SIZE];
+        size_t _pendingLength = 0;
+        uint8_t _header[ENCRYPTED_BLOCK_SIZE];
+        int _error = 0;
+        String _targetMD5;
+        MD5Builder _md5;
+    };
+}  // namespace Voyager
+
+inline bool Voyager::PartitionWriter::begin(size_t size) {
+    _partition = esp_ota_get_next_update_partition(nullptr);
+    _size = size;
+    _written = 0;
+    _flashed = 0;
+    _erasedUntil = 0;
+    _stalledErases = 0;
+    _pendingLength = 0;
+    memset(_header, 0xFF, sizeof(_header));
+    _error = 0;
+    _targetMD5 = String();
+    _md5.begin();
+
+    if (_partition == nullptr) {
+        _error = PartitionError::NO_PARTITION;
+        return false;
+    }
+
+    if (size == 0 || size > _partition->size) {
+        _error = PartitionError::TOO_LARGE;
+        return false;
+    }
+
+    // the first sector is needed right away....
+    return _eraseUntil(SECTOR_SIZE);
+}
+
+inline bool Voyager::PartitionWriter::setMD5(const char* expectedMD5) {
+    if (expectedMD5 == nullptr || strlen(expectedMD5) != 32) {
+        return false;
+    }
+
+    _targetMD5 = expectedMD5;
+    _targetMD5.toLowerCase();
+    return true;
+}
+
+inline size_t Voyager::PartitionWriter::write(uint8_t* data, size_t length) {
+    if (_error != 0) {
+        return 0;
+    }
+
+    if (_partition == nullptr) {
+        _error = PartitionError::NO_PARTITION;
+        return 0;
+    }
+
+    if (_written + length > _size) {
+        _error = PartitionError::TOO_LARGE;
+        return 0;
+    }
+
+    if (_written == 0 && length > 0 && data[0] != ESP_IMAGE_HEADER_MAGIC) {
+        _error = PartitionError::MAGIC_MISMATCH;
+        return 0;
+    }
+
+    _md5.add(data, length);
+    if (!_partition->encrypted) {
+        if (!_flash(data, length)) {
+            return 0;
+        }
+        _written += length;
+        return length;
+    }
+
+    // top up the pending block first, then write whole blocks straight from
+    // data and keep the tail for the next call....
+    const uint8_t* source = data;
+    size_t left = length;
+    if (_pendingLength > 0) {
+        size_t taken = std::min(left, ENCRYPTED_BLOCK_SIZE - _pendingLength);
+        memcpy(_pending + _pendingLength, source, taken);
+        _pendingLength += taken;
+        source += taken;
+        left -= taken;
+        if (_pendingLength == ENCRYPTED_BLOCK_SIZE) {
+            if (!_flash(_pending, ENCRYPTED_BLOCK_SIZE)) {
+                return 0;
+            }
+            _pendingLength = 0;
+        }
+    }
+
+    size_t blocks = left - (left % ENCRYPTED_BLOCK_SIZE);
+    if (blocks > 0 && !_flash(source, blocks)) {
+        return 0;
+    }
+    memcpy(_pending + _pendingLength, source + blocks, left - blocks);
+    _pendingLength += left - blocks;
+
+    _written += length;
+    return length;
+}
+
+inline bool Voyager::PartitionWriter::eraseAhead() {
+    if (_partition == nullptr || _error != 0 || _erasedUntil >= _size || _erasedUntil >= _written + ERASE_AHEAD_WINDOW) {
+        return false;
+    }
+
+    return _eraseUntil(_erasedUntil + 1);
+}
+
+inline size_t Voyager::PartitionWriter::getStalledErases() const {
+    return _stalledErases;
+}
+
+inline bool Voyager::PartitionWriter::end() {
+    if (_partition == nullptr || _error != 0) {
+        return false;
+    }
+
+    if (_written != _size) {
+        _error = PartitionError::INCOMPLETE;
+        return false;
+    }
+
+    // the tail block is padded with erased bytes, past the image but still
+    // inside its last sector....
+    if (_pendingLength > 0) {
+        memset(_pending + _pendingLength, 0xFF, ENCRYPTED_BLOCK_SIZE - _pendingLength);
+        if (!_flash(_pending, ENCRYPTED_BLOCK_SIZE)) {
+            return false;
+        }
+        _pendingLength = 0;
+    }
+
+    _md5.calculate();
+    if (!_targetMD5.isEmpty() && _md5.toString() != _targetMD5) {
+        _error = PartitionError::MD5_MISMATCH;
+        return false;
+    }
+
+    // a whole block at offset 0, aligned on encrypted flash too. What an
+    // image shorter than a block left of it is still erased bytes....
+    if (esp_partition_write(_partition, 0, _header, ENCRYPTED_BLOCK_SIZE) != ESP_OK) {
+        _error = PartitionError::WRITE_FAILED;
+        return false;
+    }
+
+    // esp_ota_set_boot_partition() validates the image before switching....
+    if (esp_ota_set_boot_partition(_partition) != ESP_OK) {
+        _error = PartitionError::ACTIVATE_FAILED;
+        return false;
+    }
+
+    _partition = nullptr;
+    return true;
+}
+
+inline void Voyager::PartitionWriter::abort() {
+    // nothing to undo, the boot partition is only switched in end()....
+    _partition = nullptr;
+}
+
+inline int Voyager::PartitionWriter::getError() const {
+    return _error;
+}
+
+inline bool Voyager::PartitionWriter::_eraseUntil(size_t offset) {
+    if (offset <= _erasedUntil) {
+        return true;
+    }
+
+    size_t eraseEnd = ((offset + SECTOR_SIZE - 1) / SECTOR_SIZE) * SECTOR_SIZE;
+    if (esp_partition_erase_range(_partition, _erasedUntil, eraseEnd - _erasedUntil) != ESP_OK) {
+        _error = PartitionError::ERASE_FAILED;
+        return false;
+    }
+
+    _erasedUntil = eraseEnd;
+    return true;
+}
+
+inline bool Voyager::PartitionWriter::_flash(const uint8_t* data, size_t length) {
+    if (_flashed + length > _erasedUntil) {
+        _stalledErases += (_flashed + length - _erasedUntil + SECTOR_SIZE - 1) / SECTOR_SIZE;
+        if (!_eraseUntil(_flashed + length)) {
+            return false;
+        }
+    }
+
+    // the header block only goes to the flash in end()....
+    if (_flashed < ENCRYPTED_BLOCK_SIZE) {
+        size_t held = std::min(length, ENCRYPTED_BLOCK_SIZE - _flashed);
+        memcpy(_header + _flashed, data, held);
+        _flashed += held;
+        data += held;
+        length -= held;
+        if (length == 0) {
+            return true;
+        }
+    }
+
+    if (esp_partition_write(_partition, _flashed, data, length) != ESP_OK) {
+        _error = PartitionError::WRITE_FAILED;
+        return false;
+    }
+
+    _flashed += length;
+    return true;
+}
+#endif
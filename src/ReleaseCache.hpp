@@ -0,0 +1,267 @@
+/******************************************************************************
+ * MIT License
+ *
+ * @headerfile [ReleaseCache.hpp]
+ *
+ * @description: Small NVS backed cache of recently seen releases and the
+ * outcome of their last update attempt.
+ *
+ * @copyright (c) 2025
+ * @author: fahadziakhan9@gmail.com (Fahad Zia Khan / Mediocre9)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef MEDIOCRE9_VOYAGER_OTA_RELEASE_CACHE_H
+#define MEDIOCRE9_VOYAGER_OTA_RELEASE_CACHE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <WString.h>
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#ifndef VOYAGER_OTA_RELEASE_CACHE_CAPACITY
+  #define VOYAGER_OTA_RELEASE_CACHE_CAPACITY 4
+#endif
+
+namespace Voyager {
+    enum class ReleaseOutcome : uint8_t {
+        UNKNOWN,
+        DEFERRED,
+        FAILED,
+        INSTALLED,
+    };
+
+    enum class ReleaseDecision : uint8_t {
+        UNKNOWN,
+        ALREADY_INSTALLED,
+        KNOWN_BAD,
+        RETRY,
+    };
+
+    // Fixed size so the whole cache is stored as a single NVS blob. Strings
+    // longer than a field are stored as their head and a hash, see
+    // ReleaseCacheHelper::copy().
+    struct ReleaseRecord {
+        uint32_t key = 0;
+        uint32_t sequence = 0;
+        char version[24] = {};
+        char releaseId[40] = {};
+        char hash[72] = {};
+        int32_t size = -1;
+        uint32_t downloadedBytes = 0;
+        ReleaseOutcome outcome = ReleaseOutcome::UNKNOWN;
+        uint8_t failures = 0;
+
+        ReleaseRecord() = default;
+
+        explicit ReleaseRecord(const String& version, const String& releaseId = String(), const String& hash = String(), int size = -1);
+
+        [[nodiscard]] bool isEmpty() const;
+
+        [[nodiscard]] bool isSameRelease(const ReleaseRecord& other) const;
+    };
+
+    class ReleaseCache {
+        static_assert(VOYAGER_OTA_RELEASE_CACHE_CAPACITY > 0, "ReleaseCache needs at least one slot!");
+
+    public:
+        explicit ReleaseCache(const char* storageNamespace = "voyager-ota");
+
+        // Loads the persisted records into RAM, every lookup after this is
+        // served from memory.
+        bool begin();
+
+        void setMaxFailures(uint8_t maxFailures);
+
+        [[nodiscard]] const ReleaseRecord* find(const ReleaseRecord& release) const;
+
+        [[nodiscard]] ReleaseDecision decide(const ReleaseRecord& release) const;
+
+        void record(const ReleaseRecord& release, ReleaseOutcome outcome, uint32_t downloadedBytes = 0);
+
+        void clear();
+
+    private:
+        bool _persist();
+
+    private:
+        static constexpr const char* STORAGE_KEY = "releases";
+
+        const char* _storageNamespace;
+        std::array<ReleaseRecord, VOYAGER_OTA_RELEASE_CACHE_CAPACITY> _records;
+        uint32_t _sequence = 0;
+        uint8_t _maxFailures = 3;
+    };
+
+    namespace ReleaseCacheHelper {
+        // FNV-1a, only used to make lookups a single integer compare....
+        inline uint32_t hash(uint32_t seed, const char* value) {
+            for (; *value != '\0'; ++value) {
+                seed = (seed ^ static_cast<uint8_t>(*value)) * 16777619u;
+            }
+            return seed;
+        }
+
+        // A value that does not fit keeps its head and ends in '~' and the
+        // hash of the whole value, so two long versions that only differ in
+        // their tail stay apart and the same value always copies the same....
+        inline void copy(char* destination, size_t capacity, const String& value) {
+            if (value.length() < capacity) {
+                memcpy(destination, value.c_str(), value.length() + 1);
+                return;
+            }
+
+            constexpr size_t SUFFIX_LENGTH = 9;
+            size_t head = capacity - 1 - SUFFIX_LENGTH;
+            memcpy(destination, value.c_str(), head);
+            snprintf(destination + head, SUFFIX_LENGTH + 1, "~%08" PRIx32, hash(2166136261u, value.c_str()));
+        }
+    }  // namespace ReleaseCacheHelper
+}  // namespace Voyager
+
+inline Voyager::ReleaseRecord::ReleaseRecord(const String& version, const String& releaseId, const String& hash, int size) : size(size) {
+    ReleaseCacheHelper::copy(this->version, sizeof(this->version), version);
+    ReleaseCacheHelper::copy(this->releaseId, sizeof(this->releaseId), releaseId);
+    ReleaseCacheHelper::copy(this->hash, sizeof(this->hash), hash);
+
+    key = ReleaseCacheHelper::hash(2166136261u, this->version);
+    key = ReleaseCacheHelper::hash(key, this->releaseId);
+    key = ReleaseCacheHelper::hash(key, this->hash);
+}
+
+inline bool Voyager::ReleaseRecord::isEmpty() const {
+    return key == 0 && version[0] == '\0';
+}
+
+inline bool Voyager::ReleaseRecord::isSameRelease(const ReleaseRecord& other) const {
+    return key == other.key &&
+           strcmp(version, other.version) == 0 &&
+           strcmp(releaseId, other.releaseId) == 0 &&
+           strcmp(hash, other.hash) == 0;
+}
+
+inline Voyager::ReleaseCache::ReleaseCache(const char* storageNamespace) : _storageNamespace(storageNamespace) {}
+
+inline bool Voyager::ReleaseCache::begin() {
+    // opened read-write, a read-only open fails until the namespace was
+    // written once, i.e. on every fresh device....
+    Preferences preferences;
+    if (!preferences.begin(_storageNamespace, false)) {
+        return false;
+    }
+
+    // a blob of another size was written by a different layout, start over....
+    if (preferences.getBytesLength(STORAGE_KEY) == sizeof(_records)) {
+        preferences.getBytes(STORAGE_KEY, _records.data(), sizeof(_records));
+    }
+    preferences.end();
+
+    for (const ReleaseRecord& record : _records) {
+        _sequence = std::max(_sequence, record.sequence);
+    }
+
+    return true;
+}
+
+inline void Voyager::ReleaseCache::setMaxFailures(uint8_t maxFailures) {
+    _maxFailures = maxFailures;
+}
+
+inline const Voyager::ReleaseRecord* Voyager::ReleaseCache::find(const ReleaseRecord& release) const {
+    for (const ReleaseRecord& record : _records) {
+        if (!record.isEmpty() && record.isSameRelease(release)) {
+            return &record;
+        }
+    }
+
+    return nullptr;
+}
+
+inline Voyager::ReleaseDecision Voyager::ReleaseCache::decide(const ReleaseRecord& release) const {
+    const ReleaseRecord* record = find(release);
+    if (record == nullptr) {
+        return ReleaseDecision::UNKNOWN;
+    }
+
+    switch (record->outcome) {
+        case ReleaseOutcome::INSTALLED:
+            return ReleaseDecision::ALREADY_INSTALLED;
+
+        case ReleaseOutcome::FAILED:
+            return record->failures >= _maxFailures ? ReleaseDecision::KNOWN_BAD : ReleaseDecision::RETRY;
+
+        case ReleaseOutcome::DEFERRED:
+            return ReleaseDecision::RETRY;
+
+        default:
+            return ReleaseDecision::UNKNOWN;
+    }
+}
+
+inline void Voyager::ReleaseCache::record(const ReleaseRecord& release, ReleaseOutcome outcome, uint32_t downloadedBytes) {
+    ReleaseRecord* slot = const_cast<ReleaseRecord*>(find(release));
+
+    if (slot == nullptr) {
+        // evict the least recently written record....
+        slot = &_records[0];
+        for (ReleaseRecord& record : _records) {
+            if (record.sequence < slot->sequence) {
+                slot = &record;
+            }
+        }
+        *slot = release;
+        slot->failures = 0;
+    }
+
+    slot->outcome = outcome;
+    slot->downloadedBytes = downloadedBytes;
+    slot->sequence = ++_sequence;
+    if (outcome == ReleaseOutcome::FAILED && slot->failures < UINT8_MAX) {
+        slot->failures++;
+    } else if (outcome == ReleaseOutcome::INSTALLED) {
+        slot->failures = 0;
+    }
+
+    _persist();
+}
+
+inline void Voyager::ReleaseCache::clear() {
+    _records.fill(ReleaseRecord());
+    _sequence = 0;
+    _persist();
+}
+
+inline bool Voyager::ReleaseCache::_persist() {
+    Preferences preferences;
+    if (!preferences.begin(_storageNamespace, false)) {
+        Serial.println("VOYAGER_OTA Release cache could not be persisted!");
+        return false;
+    }
+
+    size_t written = preferences.putBytes(STORAGE_KEY, _records.data(), sizeof(_records));
+    preferences.end();
+    return written == sizeof(_records);
+}
+#endif
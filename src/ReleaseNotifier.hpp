@@ -0,0 +1,278 @@
+/******************************************************************************
+ * MIT License
+ *
+ * @headerfile [ReleaseNotifier.hpp]
+ *
+ * @description: Optional server-sent events channel announcing new releases,
+ * with jittered polling as a fallback whenever the channel is down.
+ *
+ * @copyright (c) 2025
+ * @author: fahadziakhan9@gmail.com (Fahad Zia Khan / Mediocre9)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef MEDIOCRE9_VOYAGER_OTA_RELEASE_NOTIFIER_H
+#define MEDIOCRE9_VOYAGER_OTA_RELEASE_NOTIFIER_H
+
+#include "VoyagerOTA.hpp"
+
+namespace Voyager {
+    // Holds a text/event-stream connection open and reports when a release is
+    // announced. Call poll() from loop(), it never blocks on the stream. A
+    // poll() that (re)connects does block, for the TCP connect and again for
+    // the response headers, each bounded by the connect timeout.
+    class ReleaseNotifier {
+    public:
+        ReleaseNotifier() = default;
+
+        ReleaseNotifier(const ReleaseNotifier&) = delete;
+        ReleaseNotifier& operator=(const ReleaseNotifier&) = delete;
+
+        // Events named after eventName (default "release") trigger a fetch.
+        void setURL(const String& url, std::vector<Header> headers = std::vector<Header>(), const String& eventName = "release");
+
+        // Polling schedule used only while the channel is down.
+        void setPollInterval(uint32_t intervalMs, uint32_t jitterMs);
+
+        // Bound on each of the blocking steps of a (re)connect, 2 s by
+        // default. TLS handshakes are bounded by the client, not by this.
+        void setConnectTimeout(uint16_t timeoutMs);
+
+        // The channel is considered dropped after this long without a byte,
+        // servers are expected to send comment keep-alives more often.
+        void setIdleTimeout(uint32_t timeoutMs);
+
+        // True when fetchLatestRelease() should be called: a release has been
+        // announced, the channel has just (re)connected, or the fallback poll
+        // timer has expired.
+        [[nodiscard]] bool poll();
+
+        [[nodiscard]] bool isConnected() const;
+
+        void end();
+
+        ~ReleaseNotifier();
+
+    private:
+        bool _connect(uint32_t now);
+
+        void _disconnect(uint32_t now);
+
+        bool _readEvents(uint32_t now);
+
+        bool _dispatchLine();
+
+        [[nodiscard]] uint32_t _jitter(uint32_t range) const;
+
+    private:
+        static constexpr uint32_t MIN_RECONNECT_DELAY_MS = 1000;
+        static constexpr uint32_t MAX_RECONNECT_DELAY_MS = 5 * 60 * 1000;
+        static constexpr size_t MAX_LINE_LENGTH = 256;
+        static constexpr size_t MAX_BYTES_PER_POLL = 512;
+
+        String _url;
+        String _eventName;
+        std::vector<Header> _headers;
+
+        HTTPClient _client;
+        WiFiClient* _stream = nullptr;
+        bool _isConnected = false;
+
+        String _line;
+        String _event;
+        bool _hasData = false;
+
+        uint32_t _pollIntervalMs = 15 * 60 * 1000;
+        uint32_t _pollJitterMs = 60 * 1000;
+        uint32_t _idleTimeoutMs = 90 * 1000;
+        uint16_t _connectTimeoutMs = 2000;
+        uint32_t _reconnectDelayMs = MIN_RECONNECT_DELAY_MS;
+
+        uint32_t _nextConnectAt = 0;
+        uint32_t _nextPollAt = 0;
+        uint32_t _lastReceivedAt = 0;
+    };
+}  // namespace Voyager
+
+inline void Voyager::ReleaseNotifier::setURL(const String& url, std::vector<Header> headers, const String& eventName) {
+    _url = url;
+    _headers = headers;
+    _eventName = eventName;
+}
+
+inline void Voyager::ReleaseNotifier::setPollInterval(uint32_t intervalMs, uint32_t jitterMs) {
+    _pollIntervalMs = intervalMs;
+    _pollJitterMs = jitterMs;
+}
+
+inline void Voyager::ReleaseNotifier::setConnectTimeout(uint16_t timeoutMs) {
+    _connectTimeoutMs = timeoutMs;
+}
+
+inline void Voyager::ReleaseNotifier::setIdleTimeout(uint32_t timeoutMs) {
+    _idleTimeoutMs = timeoutMs;
+}
+
+inline bool Voyager::ReleaseNotifier::isConnected() const {
+    return _isConnected;
+}
+
+inline bool Voyager::ReleaseNotifier::poll() {
+    uint32_t now = millis();
+
+    if (_isConnected) {
+        return _readEvents(now);
+    }
+
+    if (!_url.isEmpty() && static_cast<int32_t>(now - _nextConnectAt) >= 0 && _connect(now)) {
+        // anything announced while the channel was down has been missed....
+        return true;
+    }
+
+    if (static_cast<int32_t>(now - _nextPollAt) >= 0) {
+        _nextPollAt = now + _pollIntervalMs + _jitter(_pollJitterMs);
+        return true;
+    }
+
+    return false;
+}
+
+inline void Voyager::ReleaseNotifier::end() {
+    if (_isConnected) {
+        _disconnect(millis());
+    }
+}
+
+inline Voyager::ReleaseNotifier::~ReleaseNotifier() {
+    end();
+}
+
+inline bool Voyager::ReleaseNotifier::_connect(uint32_t now) {
+    _client.useHTTP10(true);
+    _client.setReuse(false);
+    _client.setConnectTimeout(_connectTimeoutMs);
+    _client.setTimeout(_connectTimeoutMs);
+
+    if (!_client.begin(_url)) {
+        _disconnect(now);
+        return false;
+    }
+
+    HttpClientHelper::addHttpClientHeaders(_client, _headers);
+    _client.addHeader("Accept", "text/event-stream");
+    _client.addHeader("Cache-Control", "no-cache");
+
+    int statusCode = _client.GET();
+    if (statusCode != HTTP_CODE_OK) {
+        Serial.printf("VOYAGER_OTA Release channel unavailable : %d\n", statusCode);
+        _disconnect(now);
+        return false;
+    }
+
+    _stream = _client.getStreamPtr();
+    _isConnected = true;
+    _lastReceivedAt = now;
+    _reconnectDelayMs = MIN_RECONNECT_DELAY_MS;
+    _line.clear();
+    _event.clear();
+    _hasData = false;
+    return true;
+}
+
+inline void Voyager::ReleaseNotifier::_disconnect(uint32_t now) {
+    _client.end();
+    _stream = nullptr;
+
+    bool wasConnected = _isConnected;
+    _isConnected = false;
+    _nextConnectAt = now + _reconnectDelayMs + _jitter(_reconnectDelayMs / 2);
+    _reconnectDelayMs = std::min(_reconnectDelayMs * 2, MAX_RECONNECT_DELAY_MS);
+
+    if (wasConnected) {
+        // the channel may have dropped an announcement: a successful reconnect
+        // asks for a fetch anyway, a failed one falls back to this poll....
+        _nextPollAt = _nextConnectAt;
+    }
+}
+
+inline bool Voyager::ReleaseNotifier::_readEvents(uint32_t now) {
+    if (_stream == nullptr || !_stream->connected()) {
+        _disconnect(now);
+        return false;
+    }
+
+    bool isAnnounced = false;
+    size_t budget = MAX_BYTES_PER_POLL;
+
+    while (budget-- > 0 && _stream->available() > 0) {
+        int byte = _stream->read();
+        if (byte < 0) {
+            break;
+        }
+
+        _lastReceivedAt = now;
+        if (byte == '\r') {
+            continue;
+        }
+
+        if (byte == '\n') {
+            isAnnounced |= _dispatchLine();
+            _line.clear();
+        } else if (_line.length() < MAX_LINE_LENGTH) {
+            _line += static_cast<char>(byte);
+        }
+    }
+
+    if (now - _lastReceivedAt > _idleTimeoutMs) {
+        Serial.println("VOYAGER_OTA Release channel went silent, reconnecting!");
+        _disconnect(now);
+    }
+
+    return isAnnounced;
+}
+
+inline bool Voyager::ReleaseNotifier::_dispatchLine() {
+    // a blank line terminates the event....
+    if (_line.isEmpty()) {
+        bool isAnnounced = _hasData && (_event.isEmpty() ? _eventName == "message" : _event == _eventName);
+        _event.clear();
+        _hasData = false;
+        return isAnnounced;
+    }
+
+    // comment lines are keep-alives....
+    if (_line[0] == ':') {
+        return false;
+    }
+
+    if (_line.startsWith("event:")) {
+        _event = _line.substring(6);
+        _event.trim();
+    } else if (_line.startsWith("data:")) {
+        _hasData = true;
+    }
+
+    return false;
+}
+
+inline uint32_t Voyager::ReleaseNotifier::_jitter(uint32_t range) const {
+    return range == 0 ? 0 : static_cast<uint32_t>(random(range));
+}
+#endif
@@ -0,0 +1,137 @@
+/******************************************************************************
+ * MIT License
+ *
+ * @headerfile [SignatureVerifier.hpp]
+ *
+ * @description: Incremental firmware signature verification, the image is
+ * hashed while it streams into the OTA partition.
+ *
+ * @copyright (c) 2025
+ * @author: fahadziakhan9@gmail.com (Fahad Zia Khan / Mediocre9)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#ifndef MEDIOCRE9_VOYAGER_OTA_SIGNATURE_VERIFIER_H
+#define MEDIOCRE9_VOYAGER_OTA_SIGNATURE_VERIFIER_H
+
+#include <Arduino.h>
+#include <WString.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/md.h>
+#include <mbedtls/pk.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Voyager {
+    // Verifies a SHA-256 based signature (ECDSA P-256 recommended) of the whole
+    // image against a public key compiled into the firmware. Sign releases with:
+    //   openssl dgst -sha256 -sign private.pem firmware.bin | base64 -w0
+    class SignatureVerifier {
+    public:
+        explicit SignatureVerifier(const char* publicKeyPEM);
+
+        SignatureVerifier(const SignatureVerifier&) = delete;
+        SignatureVerifier& operator=(const SignatureVerifier&) = delete;
+
+        // Parses the public key on first use and starts a new digest.
+        bool begin();
+
+        void update(const uint8_t* data, size_t length);
+
+        // Finishes the digest and checks the base64 encoded DER signature.
+        [[nodiscard]] bool verify(const String& base64Signature);
+
+        ~SignatureVerifier();
+
+    private:
+        const char* _publicKeyPEM;
+        mbedtls_pk_context _publicKey;
+        // the generic md API has the same int returning signatures in mbedtls
+        // 2.x (arduino-esp32 2.x) and 3.x, unlike mbedtls_sha256_*....
+        mbedtls_md_context_t _digest;
+        bool _isKeyLoaded = false;
+        bool _isDigestReady = false;
+        bool _isDigestValid = false;
+    };
+}  // namespace Voyager
+
+inline Voyager::SignatureVerifier::SignatureVerifier(const char* publicKeyPEM) : _publicKeyPEM(publicKeyPEM) {
+    mbedtls_pk_init(&_publicKey);
+    mbedtls_md_init(&_digest);
+}
+
+inline bool Voyager::SignatureVerifier::begin() {
+    if (!_isKeyLoaded) {
+        // the PEM parser expects the terminating null byte in the length....
+        int error = mbedtls_pk_parse_public_key(&_publicKey,
+                                                reinterpret_cast<const unsigned char*>(_publicKeyPEM),
+                                                strlen(_publicKeyPEM) + 1);
+        if (error != 0) {
+            Serial.printf("VOYAGER_OTA Invalid public key : -0x%04x\n", -error);
+            return false;
+        }
+        _isKeyLoaded = true;
+    }
+
+    if (!_isDigestReady) {
+        if (mbedtls_md_setup(&_digest, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0) != 0) {
+            return false;
+        }
+        _isDigestReady = true;
+    }
+
+    _isDigestValid = mbedtls_md_starts(&_digest) == 0;
+    return _isDigestValid;
+}
+
+inline void Voyager::SignatureVerifier::update(const uint8_t* data, size_t length) {
+    if (_isDigestValid && mbedtls_md_update(&_digest, data, length) != 0) {
+        _isDigestValid = false;
+    }
+}
+
+inline bool Voyager::SignatureVerifier::verify(const String& base64Signature) {
+    uint8_t hash[32];
+    if (!_isKeyLoaded || !_isDigestValid || mbedtls_md_finish(&_digest, hash) != 0) {
+        return false;
+    }
+    _isDigestValid = false;
+
+    std::vector<uint8_t> signature((base64Signature.length() * 3) / 4 + 3);
+    size_t signatureLength = 0;
+    int error = mbedtls_base64_decode(signature.data(),
+                                      signature.size(),
+                                      &signatureLength,
+                                      reinterpret_cast<const unsigned char*>(base64Signature.c_str()),
+                                      base64Signature.length());
+    if (error != 0) {
+        Serial.println("VOYAGER_OTA Signature is not valid base64!");
+        return false;
+    }
+
+    return mbedtls_pk_verify(&_publicKey, MBEDTLS_MD_SHA256, hash, sizeof(hash), signature.data(), signatureLength) == 0;
+}
+
+inline Voyager::SignatureVerifier::~SignatureVerifier() {
+    mbedtls_md_free(&_digest);
+    mbedtls_pk_free(&_publicKey);
+}
+#endif
@@ -37,13 +37,24 @@
 
 #include <HTTPClient.h>
 #include <HTTPUpdate.h>
+#include <Update.h>
 #include <WString.h>
 #include <WiFi.h>
 #include <ArduinoJson.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include "HealthCheck.hpp"
+#include "PartitionWriter.hpp"
+#include "ReleaseCache.hpp"
+#include "SignatureVerifier.hpp"
 #include "semver/semver.hpp"
 
 #if !__ENABLE_ADVANCED_MODE__
@@ -78,6 +89,7 @@ const char* ___VYGR_PRODUCTION___ __attribute__((used)) = "$2y$10$DX0bqDwfQtWJkB
 
 using ArduinoJson::DeserializationError;
 using ArduinoJson::deserializeJson;
+using ArduinoJson::deserializeMsgPack;
 using ArduinoJson::JsonDocument;
 
 namespace Voyager {
@@ -134,18 +146,227 @@ namespace Voyager {
     };
 #endif
 
+    // Model used when OTA or IParser is declared without one.
+#if __ENABLE_ADVANCED_MODE__
+    using DefaultReleaseModel = GithubReleaseModel;
+#else
+    using DefaultReleaseModel = VoyagerReleaseModel;
+#endif
+
+    enum class PreflightVerdict : uint8_t {
+        OK,
+        UNKNOWN_SIZE,
+        IMAGE_TOO_LARGE,
+        INSUFFICIENT_HEAP,
+        NO_OTA_PARTITION,
+    };
+
+    // Outcome of the checks performed before any byte is written to flash.
+    // A size of -1 means neither the release model nor the server advertised one.
+    struct PreflightResult {
+        PreflightVerdict verdict = PreflightVerdict::OK;
+        int imageSize = -1;
+        uint32_t partitionSize = 0;
+        uint32_t freeHeap = 0;
+        uint32_t maxAllocHeap = 0;
+        uint32_t requiredHeap = 0;
+        int statusCode = 0;
+
+        [[nodiscard]] bool isOK() const {
+            return verdict == PreflightVerdict::OK || verdict == PreflightVerdict::UNKNOWN_SIZE;
+        }
+
+        // Error code reported to the onError callback for a rejected update.
+        [[nodiscard]] int errorCode() const;
+    };
+
+    namespace UpdateError {
+        constexpr int CANCELLED = -200;
+        constexpr int STREAM_TIMEOUT = -201;
+        constexpr int SIGNATURE_INVALID = -202;
+        constexpr int SIGNATURE_MISSING = -203;
+        constexpr int ROLLED_BACK_RELEASE = -204;
+        constexpr int INSUFFICIENT_HEAP = -205;
+
+        // True when the image itself is bad, as opposed to the network, the
+        // server or the device getting in the way of the download.
+        [[nodiscard]] bool isIntegrityFailure(int errorCode);
+    }  // namespace UpdateError
+
+    inline bool UpdateError::isIntegrityFailure(int errorCode) {
+        switch (errorCode) {
+            case SIGNATURE_INVALID:
+            case SIGNATURE_MISSING:
+            case HTTP_UE_SERVER_FAULTY_MD5:
+            case UPDATE_ERROR_MD5:
+            case UPDATE_ERROR_MAGIC_BYTE:
+            case UPDATE_ERROR_ACTIVATE:
+            case PartitionError::MD5_MISMATCH:
+            case PartitionError::MAGIC_MISMATCH:
+            case PartitionError::ACTIVATE_FAILED:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    inline int PreflightResult::errorCode() const {
+        switch (verdict) {
+            case PreflightVerdict::INSUFFICIENT_HEAP:
+                return UpdateError::INSUFFICIENT_HEAP;
+            case PreflightVerdict::NO_OTA_PARTITION:
+                return HTTP_UE_NO_PARTITION;
+            case PreflightVerdict::IMAGE_TOO_LARGE:
+                return HTTP_UE_TOO_LESS_SPACE;
+            default:
+                return 0;
+        }
+    }
+
+    // Thread safe flag polled by the download loop between chunks.
+    class CancellationToken {
+    public:
+        void cancel() {
+            _isCancelled.store(true, std::memory_order_relaxed);
+        }
+
+        void reset() {
+            _isCancelled.store(false, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] bool isCancelled() const {
+            return _isCancelled.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<bool> _isCancelled{false};
+    };
+
+    // Token bucket refilled from the elapsed time. A chunk larger than the
+    // bucket puts it in debt, which is paid back by sleeping, so the achieved
+    // rate tracks the configured one whatever the chunk size.
+    class RateLimiter {
+    public:
+        void setRate(uint32_t bytesPerSecond) {
+            _bytesPerSecond = bytesPerSecond;
+        }
+
+        [[nodiscard]] bool isEnabled() const {
+            return _bytesPerSecond > 0;
+        }
+
+        void reset(uint32_t nowMicros) {
+            _tokens = 0;
+            _lastRefillAt = nowMicros;
+        }
+
+        // Consumes the bytes and sleeps while the bucket is in debt, in slices
+        // of at most SLEEP_SLICE_MS so a cancel is noticed on low rates too.
+        // Returns false when the token was cancelled while sleeping.
+        [[nodiscard]] bool acquire(size_t bytes, const CancellationToken* token = nullptr) {
+            if (!isEnabled()) {
+                return true;
+            }
+
+            _refill(micros());
+            _tokens -= static_cast<int64_t>(bytes);
+
+            while (_tokens < 0) {
+                if (token != nullptr && token->isCancelled()) {
+                    return false;
+                }
+
+                uint64_t waitMicros = (static_cast<uint64_t>(-_tokens) * 1000000ULL + _bytesPerSecond - 1) / _bytesPerSecond;
+                uint64_t sliceMicros = std::min<uint64_t>(waitMicros, SLEEP_SLICE_MS * 1000ULL);
+                delay(sliceMicros / 1000);
+                delayMicroseconds(sliceMicros % 1000);
+                _refill(micros());
+            }
+            return true;
+        }
+
+    private:
+        void _refill(uint32_t nowMicros) {
+            // burst is capped to an eighth of a second worth of bytes....
+            int64_t burst = std::max<int64_t>(_bytesPerSecond / 8, 1);
+            int64_t earned = (static_cast<int64_t>(nowMicros - _lastRefillAt) * _bytesPerSecond) / 1000000LL;
+            if (_tokens + earned >= burst) {
+                _tokens = burst;
+                _lastRefillAt = nowMicros;
+                return;
+            }
+            // only the time that earned whole bytes is used up, the rest is
+            // kept for the next slice, as a slice may earn less than a byte....
+            _tokens += earned;
+            _lastRefillAt += static_cast<uint32_t>((earned * 1000000LL) / _bytesPerSecond);
+        }
+
+    private:
+        static constexpr uint32_t SLEEP_SLICE_MS = 50;
+
+        uint32_t _bytesPerSecond = 0;
+        int64_t _tokens = 0;
+        uint32_t _lastRefillAt = 0;
+    };
+
+    namespace Traits {
+        template <typename T, typename = void>
+        struct HasSize : std::false_type {};
+
+        template <typename T>
+        struct HasSize<T, std::void_t<decltype(std::declval<T&>().size)>> : std::is_convertible<decltype(std::declval<T&>().size), int> {};
+
+        template <typename T, typename = void>
+        struct HasHash : std::false_type {};
+
+        template <typename T>
+        struct HasHash<T, std::void_t<decltype(std::declval<T&>().hash)>> : std::is_convertible<decltype(std::declval<T&>().hash), String> {};
+
+        template <typename T, typename = void>
+        struct HasReleaseId : std::false_type {};
+
+        template <typename T>
+        struct HasReleaseId<T, std::void_t<decltype(std::declval<T&>().releaseId)>> : std::is_convertible<decltype(std::declval<T&>().releaseId), String> {};
+
+        template <typename T, typename T_ResponseData, typename T_PayloadModel, typename = void>
+        struct IsParser : std::false_type {};
+
+        template <typename T, typename T_ResponseData, typename T_PayloadModel>
+        struct IsParser<T, T_ResponseData, T_PayloadModel, std::void_t<decltype(std::declval<T&>().parse(std::declval<T_ResponseData>(), 0))>>
+            : std::is_same<decltype(std::declval<T&>().parse(std::declval<T_ResponseData>(), 0)), std::optional<T_PayloadModel>> {};
+
+        template <typename T, typename = void>
+        struct HasAcceptType : std::false_type {};
+
+        template <typename T>
+        struct HasAcceptType<T, std::void_t<decltype(std::declval<const T&>().acceptType())>> : std::true_type {};
+    }  // namespace Traits
+
     using HTTPResponseData = String;
-    template <typename T_ResponseData = Voyager::HTTPResponseData, typename T_PayloadModel = Voyager::VoyagerReleaseModel>
+    template <typename T_ResponseData = Voyager::HTTPResponseData, typename T_PayloadModel = Voyager::DefaultReleaseModel>
     class IParser {
         static_assert(std::is_base_of_v<BaseModel, T_PayloadModel>, "T_PayloadModel should be extended from BaseModel!");
 
     public:
         [[nodiscard]] virtual std::optional<T_PayloadModel> parse(T_ResponseData responseData, int statusCode) = 0;
 
+        // Sent as the Accept header of the release request unless one is set
+        // already. nullptr, the default, sends no Accept header at all....
+        [[nodiscard]] virtual const char* acceptType() const {
+            return nullptr;
+        }
+
         virtual ~IParser() = default;
     };
 
+    // The Static* parsers carry no vtable and are meant for StaticOTA, which
+    // calls them directly. The IParser versions forward to them.
 #if __ENABLE_ADVANCED_MODE__
+    class StaticGithubJSONParser {
+    public:
+        [[nodiscard]] std::optional<GithubReleaseModel> parse(const Voyager::HTTPResponseData& responseData, int statusCode) const;
+    };
+
     class GithubJSONParser final : public Voyager::IParser<Voyager::HTTPResponseData, GithubReleaseModel> {
     public:
         GithubJSONParser() = default;
@@ -153,12 +374,49 @@ namespace Voyager {
         [[nodiscard]] std::optional<GithubReleaseModel> parse(Voyager::HTTPResponseData responseData, int statusCode) override;
     };
 #else
+    class StaticVoyagerJSONParser {
+    public:
+        [[nodiscard]] std::optional<Voyager::VoyagerReleaseModel> parse(const Voyager::HTTPResponseData& responseData, int statusCode) const;
+    };
+
+    class StaticVoyagerMsgPackParser {
+    public:
+        [[nodiscard]] std::optional<Voyager::VoyagerReleaseModel> parse(const Voyager::HTTPResponseData& responseData, int statusCode) const;
+
+        [[nodiscard]] const char* acceptType() const {
+            return "application/msgpack, application/json;q=0.5";
+        }
+    };
+
     class VoyagerJSONParser final : public IParser<Voyager::HTTPResponseData, Voyager::VoyagerReleaseModel> {
     public:
         VoyagerJSONParser() = default;
 
         [[nodiscard]] std::optional<Voyager::VoyagerReleaseModel> parse(Voyager::HTTPResponseData responseData, int statusCode) override;
     };
+
+    // Negotiates MessagePack with the backend and decodes it straight into the
+    // release model. Falls back to JSON when the server answers with text.
+    class VoyagerMsgPackParser final : public IParser<Voyager::HTTPResponseData, Voyager::VoyagerReleaseModel> {
+    public:
+        VoyagerMsgPackParser() = default;
+
+        [[nodiscard]] std::optional<Voyager::VoyagerReleaseModel> parse(Voyager::HTTPResponseData responseData, int statusCode) override;
+
+        [[nodiscard]] const char* acceptType() const override {
+            return StaticVoyagerMsgPackParser().acceptType();
+        }
+    };
+
+    namespace ParserHelper {
+        [[nodiscard]] std::optional<Voyager::VoyagerReleaseModel> toVoyagerReleaseModel(const JsonDocument& document, int statusCode);
+    }  // namespace ParserHelper
+#endif
+
+#if __ENABLE_ADVANCED_MODE__
+    using DefaultParser = GithubJSONParser;
+#else
+    using DefaultParser = VoyagerJSONParser;
 #endif
 
     template <typename T_PayloadModel>
@@ -173,15 +431,28 @@ namespace Voyager {
         virtual ~BaseOTA() = default;
     };
 
-    template <typename T_ResponseData = Voyager::HTTPResponseData, typename T_PayloadModel = Voyager::VoyagerReleaseModel>
-    class OTA : public BaseOTA<T_PayloadModel> {
+    // Stands in for BaseOTA when the parser is resolved at compile time, so the
+    // static variant carries no vtable.
+    struct StaticOTABase {};
+
+    // With T_Parser left as void the parser is an IParser held through a
+    // unique_ptr and swappable at runtime. Any other T_Parser is stored by value
+    // and called directly, with no heap allocation and no virtual dispatch.
+    template <typename T_ResponseData = Voyager::HTTPResponseData, typename T_PayloadModel = Voyager::DefaultReleaseModel, typename T_Parser = void>
+    class OTA : public std::conditional_t<std::is_void_v<T_Parser>, BaseOTA<T_PayloadModel>, StaticOTABase> {
         static_assert(std::is_base_of_v<BaseModel, T_PayloadModel>, "Model should be extended from BaseModel!");
+        static_assert(std::is_void_v<T_Parser> || Traits::IsParser<T_Parser, T_ResponseData, T_PayloadModel>::value,
+                      "T_Parser should provide std::optional<T_PayloadModel> parse(T_ResponseData, int)!");
 
     public:
-        using Parser = std::unique_ptr<IParser<T_ResponseData, T_PayloadModel>>;
+        static constexpr bool IS_DYNAMIC = std::is_void_v<T_Parser>;
+
+        using Parser = std::conditional_t<IS_DYNAMIC, std::unique_ptr<IParser<T_ResponseData, T_PayloadModel>>, T_Parser>;
 
         OTA() = default;
 
+        // Only DefaultReleaseModel comes with a parser, any other model needs
+        // one passed here or to setParser() before fetchLatestRelease().
         explicit OTA(const String& currentVersion);
 
         explicit OTA(const String& currentVersion, Parser parser);
@@ -212,15 +483,88 @@ namespace Voyager {
 
         [[nodiscard]] bool isUpToDate(const String& release);
 
-        void performUpdate() override;
+        // Minimum free heap (bytes) required to start an update; covers the TLS
+        // handshake and the download buffers.
+        void setMinimumFreeHeap(uint32_t bytes);
+
+        // Rejects updates that can not succeed without touching the flash. When
+        // the advertised size is unknown a HEAD request is sent to the download URL.
+        [[nodiscard]] PreflightResult preflight(int advertisedSize = -1);
+
+        [[nodiscard]] const PreflightResult& getPreflightResult() const;
+
+        [[nodiscard]] t_httpUpdate_return getLastUpdateResult() const;
+
+        // Error code the last update failed with, as passed to onError, 0
+        // when it did not fail.
+        [[nodiscard]] int getLastError() const;
+
+        // Outcomes of update attempts are recorded in the cache, so a release
+        // seen before can be judged without any network I/O.
+        void setReleaseCache(ReleaseCache& cache);
+
+        [[nodiscard]] ReleaseDecision getReleaseDecision(const T_PayloadModel& release) const;
+
+        // Successful updates are marked pending in the boot record, and a
+        // version the health check rolled back is never downloaded again.
+        void setHealthCheck(HealthCheck& healthCheck);
+
+        // Every downloaded image is hashed as it streams into the partition and
+        // only marked bootable when its signature verifies.
+        void setSignatureVerifier(SignatureVerifier& verifier);
 
-        [[nodiscard]] std::optional<T_PayloadModel> fetchLatestRelease() override;
+        // Base64 signature of the next image; when empty the x-signature header
+        // of the download response is used.
+        void setSignature(const String& base64Signature);
+
+        // Writes the image through PartitionWriter, which erases flash sectors
+        // ahead of the write cursor while the network is idle.
+        void setFlashPreErase(bool isEnabled);
+
+        // Caps the firmware download at the given rate, 0 disables the limit.
+        void setDownloadRateLimit(uint32_t bytesPerSecond);
+
+        void performUpdate();
+
+        // Same as performUpdate() but aborts the download, leaving the running
+        // image untouched, as soon as the token is cancelled.
+        void performUpdate(const CancellationToken& token);
+
+        [[nodiscard]] std::optional<T_PayloadModel> fetchLatestRelease();
 
         ~OTA() = default;
 
     private:
         void _otaUpdateHandler(HTTPClient& client);
 
+        [[nodiscard]] auto& _parserRef();
+
+        [[nodiscard]] const char* _acceptType();
+
+        [[nodiscard]] static ReleaseRecord _toReleaseRecord(const T_PayloadModel& release);
+
+        // Same contract as HTTPUpdate::handleUpdate(): the error code is only
+        // set when the result is HTTP_UPDATE_FAILED.
+        [[nodiscard]] t_httpUpdate_return _downloadFirmware(HTTPClient& client,
+                                                            int& errorCode,
+                                                            const HTTPUpdateStartCB& onStart,
+                                                            const HTTPUpdateProgressCB& onProgress,
+                                                            const HTTPUpdateEndCB& onEnd);
+
+        template <typename T_Writer>
+        [[nodiscard]] int _streamFirmware(HTTPClient& client,
+                                          T_Writer& writer,
+                                          int size,
+                                          const String& signature,
+                                          const String& md5,
+                                          const HTTPUpdateStartCB& onStart,
+                                          const HTTPUpdateProgressCB& onProgress,
+                                          const HTTPUpdateEndCB& onEnd);
+
+        // The writer's error code, never 0 once it failed.
+        template <typename T_Writer>
+        [[nodiscard]] static int _writerError(T_Writer& writer);
+
     private:
         Parser _parser;
         String _currentVersion;
@@ -228,6 +572,33 @@ namespace Voyager {
         String _downloadURL;
         std::vector<Header> _downloadHeaders;
 
+        static constexpr uint32_t DEFAULT_MINIMUM_FREE_HEAP = 48 * 1024;
+        static constexpr size_t DOWNLOAD_BUFFER_SIZE = 1024;
+        // onProgress fires once per flash sector, as it did through httpUpdate....
+        static constexpr size_t PROGRESS_INTERVAL = 4096;
+        static constexpr uint32_t DOWNLOAD_TIMEOUT_MS = 10000;
+        static constexpr const char* SIGNATURE_HEADER = "x-signature";
+        static constexpr const char* MD5_HEADER = "x-MD5";
+
+        int _advertisedSize = -1;
+        uint32_t _minimumFreeHeap = DEFAULT_MINIMUM_FREE_HEAP;
+        PreflightResult _preflightResult;
+        t_httpUpdate_return _lastUpdateResult = HTTP_UPDATE_NO_UPDATES;
+        int _lastError = 0;
+
+        RateLimiter _rateLimiter;
+        uint32_t _downloadedBytes = 0;
+
+        ReleaseCache* _releaseCache = nullptr;
+        HealthCheck* _healthCheck = nullptr;
+        std::optional<ReleaseRecord> _pendingRelease;
+        const CancellationToken* _cancellationToken = nullptr;
+
+        bool _isPreEraseEnabled = false;
+
+        SignatureVerifier* _signatureVerifier = nullptr;
+        String _signature;
+
         // update event callbacks....
         HTTPUpdateStartCB _onStart;
         HTTPUpdateProgressCB _onProgress;
@@ -242,6 +613,7 @@ namespace Voyager {
         String _apiKey;
         String _projectId;
         String _baseURL;
+        String _latestReleaseURL;
         std::vector<Header> _voyagerHeaders;
 
     private:
@@ -249,47 +621,114 @@ namespace Voyager {
 #endif
     };
 
+    // Compile-time configured client, the payload model is taken from the
+    // parser's return type, e.g. StaticOTA<StaticVoyagerJSONParser>.
+    template <typename T_Parser, typename T_ResponseData = Voyager::HTTPResponseData>
+    using StaticOTA = OTA<T_ResponseData, typename decltype(std::declval<T_Parser&>().parse(std::declval<T_ResponseData>(), 0))::value_type, T_Parser>;
+
     namespace HttpClientHelper {
-        inline void addHttpClientHeaders(HTTPClient& client, const std::vector<Voyager::Header> headers) {
-            for (const auto [type, value] : headers) {
+        inline void addHttpClientHeaders(HTTPClient& client, const std::vector<Voyager::Header>& headers) {
+            for (const auto& [type, value] : headers) {
                 if (!client.hasHeader(type)) {
                     client.addHeader(type, value);
                 }
             }
         }
+
+        // The request headers HTTPUpdate::handleUpdate() sends with the image
+        // request, servers may pick or refuse the image based on them.
+        inline void addUpdateHeaders(HTTPClient& client) {
+            client.setUserAgent("ESP32-http-Update");
+            client.addHeader("Cache-Control", "no-cache");
+            client.addHeader("x-ESP32-STA-MAC", WiFi.macAddress());
+            client.addHeader("x-ESP32-AP-MAC", WiFi.softAPmacAddress());
+            client.addHeader("x-ESP32-free-space", String(ESP.getFreeSketchSpace()));
+            client.addHeader("x-ESP32-sketch-size", String(ESP.getSketchSize()));
+
+            String sketchMD5 = ESP.getSketchMD5();
+            if (!sketchMD5.isEmpty()) {
+                client.addHeader("x-ESP32-sketch-md5", sketchMD5);
+            }
+
+            uint8_t sha256[32];
+            if (esp_partition_get_sha256(esp_ota_get_running_partition(), sha256) == ESP_OK) {
+                char sketchSHA256[2 * sizeof(sha256) + 1];
+                for (size_t i = 0; i < sizeof(sha256); i++) {
+                    snprintf(sketchSHA256 + 2 * i, 3, "%02X", sha256[i]);
+                }
+                client.addHeader("x-ESP32-sketch-sha256", sketchSHA256);
+            }
+
+            client.addHeader("x-ESP32-chip-size", String(ESP.getFlashChipSize()));
+            client.addHeader("x-ESP32-sdk-version", ESP.getSdkVersion());
+            client.addHeader("x-ESP32-mode", "sketch");
+        }
+
+        inline bool containsHeader(const std::vector<Voyager::Header>& headers, const char* type) {
+            for (const auto& [key, value] : headers) {
+                if (strcasecmp(key, type) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
     }  // namespace HttpClientHelper
 }  // namespace Voyager
 
-template <typename T_ResponseData, typename T_PayloadModel>
-Voyager::OTA<T_ResponseData, T_PayloadModel>::OTA(const String& currentVersion)
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::OTA(const String& currentVersion)
     : _currentVersion(currentVersion) {
-    _parser = std::make_unique<VoyagerJSONParser>();
+    if constexpr (IS_DYNAMIC && std::is_same_v<T_PayloadModel, DefaultReleaseModel>) {
+        _parser = std::make_unique<DefaultParser>();
+    }
 }
 
-template <typename T_ResponseData, typename T_PayloadModel>
-Voyager::OTA<T_ResponseData, T_PayloadModel>::OTA(const String& currentVersion, Parser parser)
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::OTA(const String& currentVersion, Parser parser)
     : _currentVersion(currentVersion), _parser(std::move(parser)) {}
 
-template <typename T_ResponseData, typename T_PayloadModel>
-Voyager::OTA<T_ResponseData, T_PayloadModel>::OTA(Parser parser)
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::OTA(Parser parser)
     : _parser(std::move(parser)) {}
 
-template <typename T_ResponseData, typename T_PayloadModel>
-void Voyager::OTA<T_ResponseData, T_PayloadModel>::setParser(Parser parser) {
-    if (_parser == nullptr) {
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::setParser(Parser parser) {
+    if constexpr (IS_DYNAMIC) {
+        if (_parser == nullptr) {
+            _parser = std::move(parser);
+        }
+    } else {
         _parser = std::move(parser);
     }
 }
 
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+auto& Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::_parserRef() {
+    if constexpr (IS_DYNAMIC) {
+        return *_parser;
+    } else {
+        return _parser;
+    }
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+const char* Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::_acceptType() {
+    if constexpr (IS_DYNAMIC || Traits::HasAcceptType<T_Parser>::value) {
+        return _parserRef().acceptType();
+    } else {
+        return nullptr;
+    }
+}
+
 #if __ENABLE_ADVANCED_MODE__
-template <typename T_ResponseData, typename T_PayloadModel>
-void Voyager::OTA<T_ResponseData, T_PayloadModel>::setReleaseURL(const String& endpoint, std::vector<Header> headers) {
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::setReleaseURL(const String& endpoint, std::vector<Header> headers) {
     _releaseURL = endpoint;
     _releaseHeaders = headers;
 }
 #else
-template <typename T_ResponseData, typename T_PayloadModel>
-void Voyager::OTA<T_ResponseData, T_PayloadModel>::setCredentials(const String& projectId, const String& apiKey) {
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::setCredentials(const String& projectId, const String& apiKey) {
     _projectId = projectId;
     _apiKey = apiKey;
     _setVoyagerHeaders({
@@ -298,25 +737,36 @@ void Voyager::OTA<T_ResponseData, T_PayloadModel>::setCredentials(const String&
     });
 }
 
-template <typename T_ResponseData, typename T_PayloadModel>
-void Voyager::OTA<T_ResponseData, T_PayloadModel>::_setVoyagerHeaders(std::vector<Header> headers) {
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::_setVoyagerHeaders(std::vector<Header> headers) {
     _voyagerHeaders = headers;
 }
 
-template <typename T_ResponseData, typename T_PayloadModel>
-void Voyager::OTA<T_ResponseData, T_PayloadModel>::setBaseURL(const String& url) {
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::setBaseURL(const String& url) {
     _baseURL = url;
+
+#if __ENABLE_DEVELOPMENT_MODE__
+    const auto& endpoint = __VoyagerApi__::Endpoints::LATEST_STAGING_RELEASE;
+#else
+    const auto& endpoint = __VoyagerApi__::Endpoints::LATEST_PRODUCTION_RELEASE;
+#endif
+
+    _latestReleaseURL = String();
+    _latestReleaseURL.reserve(_baseURL.length() + endpoint.size());
+    _latestReleaseURL.concat(_baseURL);
+    _latestReleaseURL.concat(endpoint.data());
 }
 #endif
 
-template <typename T_ResponseData, typename T_PayloadModel>
-void Voyager::OTA<T_ResponseData, T_PayloadModel>::setDownloadURL(const String& endpoint, std::vector<Header> headers) {
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::setDownloadURL(const String& endpoint, std::vector<Header> headers) {
     _downloadURL = endpoint;
     _downloadHeaders = headers;
 }
 
-template <typename T_ResponseData, typename T_PayloadModel>
-void Voyager::OTA<T_ResponseData, T_PayloadModel>::attachEventCallbacks(HTTPUpdateStartCB onStart,
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::attachEventCallbacks(HTTPUpdateStartCB onStart,
                                                                         HTTPUpdateProgressCB onProgress,
                                                                         HTTPUpdateEndCB onEnd,
                                                                         HTTPUpdateErrorCB onError) {
@@ -326,36 +776,42 @@ void Voyager::OTA<T_ResponseData, T_PayloadModel>::attachEventCallbacks(HTTPUpda
     _onError = onError;
 }
 
-template <typename T_ResponseData, typename T_PayloadModel>
-void Voyager::OTA<T_ResponseData, T_PayloadModel>::setCurrentVersion(const String& currentVersion) {
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::setCurrentVersion(const String& currentVersion) {
     _currentVersion = currentVersion;
 }
 
-template <typename T_ResponseData, typename T_PayloadModel>
-const String& Voyager::OTA<T_ResponseData, T_PayloadModel>::getCurrentVersion() const {
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+const String& Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::getCurrentVersion() const {
     return _currentVersion;
 }
 
-template <typename T_ResponseData, typename T_PayloadModel>
-bool Voyager::OTA<T_ResponseData, T_PayloadModel>::isNewVersion(const String& release) {
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+bool Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::isNewVersion(const String& release) {
     return semver::version::parse(release.c_str(), false) > semver::version::parse(_currentVersion.c_str(), false);
 }
 
-template <typename T_ResponseData, typename T_PayloadModel>
-bool Voyager::OTA<T_ResponseData, T_PayloadModel>::isUpToDate(const String& release) {
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+bool Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::isUpToDate(const String& release) {
     return semver::version::parse(_currentVersion.c_str(), false) >= semver::version::parse(release.c_str(), false);
 }
 
-template <typename T_ResponseData, typename T_PayloadModel>
-std::optional<T_PayloadModel> Voyager::OTA<T_ResponseData, T_PayloadModel>::fetchLatestRelease() {
-    String url;
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+std::optional<T_PayloadModel> Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::fetchLatestRelease() {
+    if constexpr (IS_DYNAMIC) {
+        if (_parser == nullptr) {
+            Serial.println("Parser is required!");
+            return std::nullopt;
+        }
+    }
+
 #if __ENABLE_ADVANCED_MODE__
     if (_releaseURL.isEmpty()) {
         Serial.println("Release URL is required!");
         return std::nullopt;
     }
 
-    url = _releaseURL;
+    const String& url = _releaseURL;
 
 #else
     if (_baseURL.isEmpty()) {
@@ -373,11 +829,8 @@ std::optional<T_PayloadModel> Voyager::OTA<T_ResponseData, T_PayloadModel>::fetc
         return std::nullopt;
     }
 
-  #if __ENABLE_DEVELOPMENT_MODE__
-    url = _baseURL + __VoyagerApi__::Endpoints::LATEST_RELEASE + __VoyagerApi__::QueryParams::STAGING_CHANNEL;
-  #else
-    url = _baseURL + __VoyagerApi__::Endpoints::LATEST_RELEASE + __VoyagerApi__::QueryParams::PRODUCTION_CHANNEL;
-  #endif
+    // composed once in setBaseURL(), nothing is concatenated per poll....
+    const String& url = _latestReleaseURL;
 #endif
 
     // TODO Deprecate the HTTPClient module in favour of AsyncTCP client for async API calls.......
@@ -390,21 +843,152 @@ std::optional<T_PayloadModel> Voyager::OTA<T_ResponseData, T_PayloadModel>::fetc
     }
 
 #if __ENABLE_ADVANCED_MODE__
-    std::vector<Header> headers = _releaseHeaders;
+    const std::vector<Header>& headers = _releaseHeaders;
 #else
-    std::vector<Header> headers = _voyagerHeaders;
+    const std::vector<Header>& headers = _voyagerHeaders;
 #endif
 
+    // the configured headers are not copied per poll....
     HttpClientHelper::addHttpClientHeaders(client, headers);
+    const char* acceptType = _acceptType();
+    if (acceptType != nullptr && !HttpClientHelper::containsHeader(headers, "Accept")) {
+        client.addHeader("Accept", acceptType);
+    }
 
     int statusCode = client.GET();
     Voyager::HTTPResponseData responseData = client.getString();
     client.end();
-    return _parser->parse(responseData, statusCode);
+
+    std::optional<T_PayloadModel> release = _parserRef().parse(responseData, statusCode);
+    if constexpr (Traits::HasSize<T_PayloadModel>::value) {
+        if (release) {
+            _advertisedSize = release->size;
+        }
+    }
+
+    if (release) {
+        _pendingRelease = _toReleaseRecord(*release);
+    }
+
+    return release;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::setReleaseCache(ReleaseCache& cache) {
+    _releaseCache = &cache;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+Voyager::ReleaseDecision Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::getReleaseDecision(const T_PayloadModel& release) const {
+    if (_healthCheck != nullptr && _healthCheck->isFailedVersion(release.version)) {
+        return ReleaseDecision::KNOWN_BAD;
+    }
+
+    if (_releaseCache == nullptr) {
+        return ReleaseDecision::UNKNOWN;
+    }
+
+    return _releaseCache->decide(_toReleaseRecord(release));
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::setHealthCheck(HealthCheck& healthCheck) {
+    _healthCheck = &healthCheck;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+Voyager::ReleaseRecord Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::_toReleaseRecord(const T_PayloadModel& release) {
+    String releaseId;
+    String hash;
+    int size = -1;
+
+    if constexpr (Traits::HasReleaseId<T_PayloadModel>::value) {
+        releaseId = release.releaseId;
+    }
+
+    if constexpr (Traits::HasHash<T_PayloadModel>::value) {
+        hash = release.hash;
+    }
+
+    if constexpr (Traits::HasSize<T_PayloadModel>::value) {
+        size = release.size;
+    }
+
+    return ReleaseRecord(release.version, releaseId, hash, size);
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::setMinimumFreeHeap(uint32_t bytes) {
+    _minimumFreeHeap = bytes;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+Voyager::PreflightResult Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::preflight(int advertisedSize) {
+    PreflightResult result;
+    result.freeHeap = ESP.getFreeHeap();
+    result.maxAllocHeap = ESP.getMaxAllocHeap();
+    result.requiredHeap = _minimumFreeHeap;
+    result.partitionSize = ESP.getFreeSketchSpace();
+
+    // heap and partition checks are local, so they run before any network I/O....
+    // the TLS buffers need one contiguous block, a fragmented heap fails the
+    // handshake whatever the total free heap is....
+    if (result.maxAllocHeap < _minimumFreeHeap) {
+        result.verdict = PreflightVerdict::INSUFFICIENT_HEAP;
+        return result;
+    }
+
+    if (result.partitionSize == 0) {
+        result.verdict = PreflightVerdict::NO_OTA_PARTITION;
+        return result;
+    }
+
+    result.imageSize = advertisedSize;
+    if (result.imageSize <= 0 && !_downloadURL.isEmpty()) {
+        HTTPClient client;
+        if (client.begin(_downloadURL)) {
+#if __ENABLE_ADVANCED_MODE__
+            const std::vector<Header>& headers = _downloadHeaders;
+#else
+            const std::vector<Header>& headers = _voyagerHeaders.empty() ? _downloadHeaders : _voyagerHeaders;
+#endif
+            HttpClientHelper::addHttpClientHeaders(client, headers);
+            client.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+
+            // A failed HEAD (e.g. pre-signed URLs only valid for GET) is not a rejection....
+            result.statusCode = client.sendRequest("HEAD");
+            if (result.statusCode == HTTP_CODE_OK) {
+                result.imageSize = client.getSize();
+            }
+            client.end();
+        }
+    }
+
+    if (result.imageSize <= 0) {
+        result.verdict = PreflightVerdict::UNKNOWN_SIZE;
+        return result;
+    }
+
+    if (static_cast<uint32_t>(result.imageSize) > result.partitionSize) {
+        result.verdict = PreflightVerdict::IMAGE_TOO_LARGE;
+        return result;
+    }
+
+    result.verdict = PreflightVerdict::OK;
+    return result;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+const Voyager::PreflightResult& Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::getPreflightResult() const {
+    return _preflightResult;
 }
 
 #if __ENABLE_ADVANCED_MODE__
 std::optional<Voyager::GithubReleaseModel> Voyager::GithubJSONParser::parse(Voyager::HTTPResponseData responseData, int statusCode) {
+    return StaticGithubJSONParser().parse(responseData, statusCode);
+}
+
+inline std::optional<Voyager::GithubReleaseModel> Voyager::StaticGithubJSONParser::parse(const Voyager::HTTPResponseData& responseData, int statusCode) const {
     JsonDocument document;
     DeserializationError error = deserializeJson(document, responseData);
 
@@ -430,6 +1014,14 @@ std::optional<Voyager::GithubReleaseModel> Voyager::GithubJSONParser::parse(Voya
 }
 #else
 std::optional<Voyager::VoyagerReleaseModel> Voyager::VoyagerJSONParser::parse(Voyager::HTTPResponseData responseData, int statusCode) {
+    return StaticVoyagerJSONParser().parse(responseData, statusCode);
+}
+
+inline std::optional<Voyager::VoyagerReleaseModel> Voyager::VoyagerMsgPackParser::parse(Voyager::HTTPResponseData responseData, int statusCode) {
+    return StaticVoyagerMsgPackParser().parse(responseData, statusCode);
+}
+
+inline std::optional<Voyager::VoyagerReleaseModel> Voyager::StaticVoyagerJSONParser::parse(const Voyager::HTTPResponseData& responseData, int statusCode) const {
     JsonDocument document;
     DeserializationError error = deserializeJson(document, responseData);
 
@@ -438,6 +1030,33 @@ std::optional<Voyager::VoyagerReleaseModel> Voyager::VoyagerJSONParser::parse(Vo
         return std::nullopt;
     }
 
+    return ParserHelper::toVoyagerReleaseModel(document, statusCode);
+}
+
+inline std::optional<Voyager::VoyagerReleaseModel> Voyager::StaticVoyagerMsgPackParser::parse(const Voyager::HTTPResponseData& responseData, int statusCode) const {
+    JsonDocument document;
+    DeserializationError error;
+
+    // a MessagePack map never starts with '{' or whitespace, so a text body is
+    // a JSON fallback from a backend that does not speak MessagePack....
+    char first = responseData.length() > 0 ? responseData[0] : '\0';
+    bool isJSON = first == '{' || first == '[' || first == ' ' || first == '\n' || first == '\r' || first == '\t';
+
+    if (isJSON) {
+        error = deserializeJson(document, responseData);
+    } else {
+        error = deserializeMsgPack(document, responseData.c_str(), responseData.length());
+    }
+
+    if (error) {
+        Serial.printf("VOYAGER_OTA_%s_Error : %s\n", isJSON ? "JSON" : "MSGPACK", error.c_str());
+        return std::nullopt;
+    }
+
+    return ParserHelper::toVoyagerReleaseModel(document, statusCode);
+}
+
+inline std::optional<Voyager::VoyagerReleaseModel> Voyager::ParserHelper::toVoyagerReleaseModel(const JsonDocument& document, int statusCode) {
     if (statusCode != HTTP_CODE_OK) {
         String errorMessage = document["message"];
         Serial.println(errorMessage);
@@ -459,70 +1078,333 @@ std::optional<Voyager::VoyagerReleaseModel> Voyager::VoyagerJSONParser::parse(Vo
 }
 #endif
 
-template <typename T_ResponseData, typename T_PayloadModel>
-void Voyager::OTA<T_ResponseData, T_PayloadModel>::performUpdate() {
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+t_httpUpdate_return Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::getLastUpdateResult() const {
+    return _lastUpdateResult;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+int Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::getLastError() const {
+    return _lastError;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::setSignatureVerifier(SignatureVerifier& verifier) {
+    _signatureVerifier = &verifier;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::setSignature(const String& base64Signature) {
+    _signature = base64Signature;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::setFlashPreErase(bool isEnabled) {
+    _isPreEraseEnabled = isEnabled;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::setDownloadRateLimit(uint32_t bytesPerSecond) {
+    _rateLimiter.setRate(bytesPerSecond);
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::performUpdate(const CancellationToken& token) {
+    _cancellationToken = &token;
+    performUpdate();
+    _cancellationToken = nullptr;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::performUpdate() {
+    _lastUpdateResult = HTTP_UPDATE_FAILED;
+    _lastError = 0;
+
     HTTPClient client;
     if (_downloadURL.isEmpty()) {
         Serial.print("Download URL is required!");
         return;
     }
 
+    if (_healthCheck != nullptr && _pendingRelease && _healthCheck->isFailedVersion(_pendingRelease->version)) {
+        Serial.printf("VOYAGER_OTA Release %s was rolled back, skipping!\n", _pendingRelease->version);
+        _lastError = UpdateError::ROLLED_BACK_RELEASE;
+        if (_onError) {
+            _onError(UpdateError::ROLLED_BACK_RELEASE);
+        }
+        return;
+    }
+
+    _preflightResult = preflight(_advertisedSize);
+    if (!_preflightResult.isOK()) {
+        Serial.printf("VOYAGER_OTA PREFLIGHT_FAILED : verdict %d, image %d bytes, partition %" PRIu32 " bytes, free heap %" PRIu32 " bytes, largest block %" PRIu32 " bytes\n",
+                      static_cast<int>(_preflightResult.verdict),
+                      _preflightResult.imageSize,
+                      _preflightResult.partitionSize,
+                      _preflightResult.freeHeap,
+                      _preflightResult.maxAllocHeap);
+        _lastError = _preflightResult.errorCode();
+        if (_onError) {
+            _onError(_preflightResult.errorCode());
+        }
+        return;
+    }
+
     bool isOK = client.begin(_downloadURL);
 
     // TODO Add error log message.....
     if (!isOK) {
+        _lastError = HTTPC_ERROR_CONNECTION_REFUSED;
         return;
     }
 
-    std::vector<Header> headers = _voyagerHeaders.empty() ? _downloadHeaders : _voyagerHeaders;
+#if __ENABLE_ADVANCED_MODE__
+    const std::vector<Header>& headers = _downloadHeaders;
+#else
+    const std::vector<Header>& headers = _voyagerHeaders.empty() ? _downloadHeaders : _voyagerHeaders;
+#endif
     HttpClientHelper::addHttpClientHeaders(client, headers);
 
     _otaUpdateHandler(client);
 }
 
-template <typename T_ResponseData, typename T_PayloadModel>
-void Voyager::OTA<T_ResponseData, T_PayloadModel>::_otaUpdateHandler(HTTPClient& client) {
-    if (_onStart && _onProgress && _onEnd && _onError) {
-        httpUpdate.onStart(_onStart);
-        httpUpdate.onProgress(_onProgress);
-        httpUpdate.onEnd(_onEnd);
-        httpUpdate.onError(_onError);
-    } else {
-        httpUpdate.onStart([this]() -> void {
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+void Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::_otaUpdateHandler(HTTPClient& client) {
+    HTTPUpdateStartCB onStart = _onStart;
+    HTTPUpdateProgressCB onProgress = _onProgress;
+    HTTPUpdateEndCB onEnd = _onEnd;
+    HTTPUpdateErrorCB onError = _onError;
+
+    if (!(_onStart && _onProgress && _onEnd && _onError)) {
+        onStart = []() -> void {
             Serial.println("==== VoyagerOTA update has been started! ====");
-        });
+        };
 
-        httpUpdate.onProgress([this](int current, int total) -> void {
+        onProgress = [](int current, int total) -> void {
             int percent = (current * 100) / total;
             Serial.printf("==== Downloading: %d out of 100%% ====\n", percent);
-        });
+        };
 
-        httpUpdate.onEnd([this]() -> void {
+        onEnd = []() -> void {
             Serial.println("==== VoyagerOTA update has finished! ====");
-        });
+        };
 
-        httpUpdate.onError([this](int errorCode) -> void {
+        onError = [](int errorCode) -> void {
             Serial.printf("==== VoyagerOTA Update Error Code : %d ====", errorCode);
-        });
+        };
     }
 
-    httpUpdate.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
-    t_httpUpdate_return updateResult = httpUpdate.update(client);
+    int errorCode = 0;
+    _lastUpdateResult = _downloadFirmware(client, errorCode, onStart, onProgress, onEnd);
+    _lastError = _lastUpdateResult == HTTP_UPDATE_FAILED ? errorCode : 0;
+    client.end();
+
+    // persisted before the reboot below....
+    if (_releaseCache != nullptr && _pendingRelease) {
+        // only a bad image counts towards KNOWN_BAD, a dropped connection or
+        // a busy server is worth another try....
+        ReleaseOutcome outcome = ReleaseOutcome::DEFERRED;
+        if (_lastUpdateResult == HTTP_UPDATE_OK) {
+            outcome = ReleaseOutcome::INSTALLED;
+        } else if (_lastUpdateResult == HTTP_UPDATE_FAILED && UpdateError::isIntegrityFailure(errorCode)) {
+            outcome = ReleaseOutcome::FAILED;
+        }
+        _releaseCache->record(*_pendingRelease, outcome, _downloadedBytes);
+    }
 
-    switch (updateResult) {
+    switch (_lastUpdateResult) {
         case HTTP_UPDATE_OK: {
             Serial.println("VOYAGER_OTA HTTP_UPDATE_OK");
+            if (_healthCheck != nullptr) {
+                _healthCheck->markPending(_pendingRelease ? String(_pendingRelease->version) : String());
+            }
+            ESP.restart();
         } break;
 
         case HTTP_UPDATE_FAILED: {
-            Serial.printf("VOYAGER_OTA HTTP_UPDATE_FAILED : %s  ERROR CODE :  %d", httpUpdate.getLastErrorString(), httpUpdate.getLastError());
+            onError(errorCode);
+            Serial.printf("VOYAGER_OTA HTTP_UPDATE_FAILED : ERROR CODE :  %d", errorCode);
         } break;
 
         default: {
             Serial.println("VOYAGER_OTA NO_HTTP_UPDATE_AVAILABLE");
         } break;
     }
+}
 
-    client.end();
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+t_httpUpdate_return Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::_downloadFirmware(HTTPClient& client,
+                                                                                               int& errorCode,
+                                                                                               const HTTPUpdateStartCB& onStart,
+                                                                                               const HTTPUpdateProgressCB& onProgress,
+                                                                                               const HTTPUpdateEndCB& onEnd) {
+    _downloadedBytes = 0;
+    client.useHTTP10(true);
+    client.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+    HttpClientHelper::addUpdateHeaders(client);
+
+    const char* collectedHeaders[] = {SIGNATURE_HEADER, MD5_HEADER};
+    client.collectHeaders(collectedHeaders, 2);
+
+    int statusCode = client.GET();
+
+    switch (statusCode) {
+        case HTTP_CODE_OK:
+            break;
+        case HTTP_CODE_NOT_MODIFIED:
+            return HTTP_UPDATE_NO_UPDATES;
+        case HTTP_CODE_NOT_FOUND:
+            errorCode = HTTP_UE_SERVER_FILE_NOT_FOUND;
+            return HTTP_UPDATE_FAILED;
+        case HTTP_CODE_FORBIDDEN:
+            errorCode = HTTP_UE_SERVER_FORBIDDEN;
+            return HTTP_UPDATE_FAILED;
+        default:
+            errorCode = HTTP_UE_SERVER_WRONG_HTTP_CODE;
+            return HTTP_UPDATE_FAILED;
+    }
+
+    int size = client.getSize();
+    if (size <= 0) {
+        errorCode = HTTP_UE_SERVER_NOT_REPORT_SIZE;
+        return HTTP_UPDATE_FAILED;
+    }
+
+    String signature;
+    if (_signatureVerifier != nullptr) {
+        signature = _signature.isEmpty() ? client.header(SIGNATURE_HEADER) : _signature;
+        if (signature.isEmpty()) {
+            errorCode = UpdateError::SIGNATURE_MISSING;
+            return HTTP_UPDATE_FAILED;
+        }
+
+        if (!_signatureVerifier->begin()) {
+            errorCode = UpdateError::SIGNATURE_INVALID;
+            return HTTP_UPDATE_FAILED;
+        }
+    }
+
+    String md5 = client.header(MD5_HEADER);
+    if (_isPreEraseEnabled) {
+        PartitionWriter writer;
+        errorCode = _streamFirmware(client, writer, size, signature, md5, onStart, onProgress, onEnd);
+#if __ENABLE_DEVELOPMENT_MODE__
+        Serial.printf("VOYAGER_OTA %u flash sectors were erased in the write path\n", static_cast<unsigned>(writer.getStalledErases()));
+#endif
+    } else {
+        errorCode = _streamFirmware(client, Update, size, signature, md5, onStart, onProgress, onEnd);
+    }
+
+    return errorCode == 0 ? HTTP_UPDATE_OK : HTTP_UPDATE_FAILED;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+template <typename T_Writer>
+int Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::_streamFirmware(HTTPClient& client,
+                                                                            T_Writer& writer,
+                                                                            int size,
+                                                                            const String& signature,
+                                                                            const String& md5,
+                                                                            const HTTPUpdateStartCB& onStart,
+                                                                            const HTTPUpdateProgressCB& onProgress,
+                                                                            const HTTPUpdateEndCB& onEnd) {
+    if (!writer.begin(size)) {
+        return std::is_same_v<T_Writer, PartitionWriter> ? writer.getError() : HTTP_UE_TOO_LESS_SPACE;
+    }
+
+    if (!md5.isEmpty() && !writer.setMD5(md5.c_str())) {
+        writer.abort();
+        return HTTP_UE_SERVER_FAULTY_MD5;
+    }
+
+    std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[DOWNLOAD_BUFFER_SIZE]);
+    if (buffer == nullptr) {
+        writer.abort();
+        return HTTP_UE_TOO_LESS_SPACE;
+    }
+
+    onStart();
+    onProgress(0, size);
+    _rateLimiter.reset(micros());
+
+    WiFiClient* stream = client.getStreamPtr();
+    size_t remaining = static_cast<size_t>(size);
+    uint32_t lastReceivedAt = millis();
+
+    while (remaining > 0) {
+        if (_cancellationToken != nullptr && _cancellationToken->isCancelled()) {
+            writer.abort();
+            return UpdateError::CANCELLED;
+        }
+
+        size_t available = stream->available();
+        if (available == 0) {
+            if (!client.connected() || millis() - lastReceivedAt > DOWNLOAD_TIMEOUT_MS) {
+                writer.abort();
+                return UpdateError::STREAM_TIMEOUT;
+            }
+
+            // erase upcoming sectors while waiting on the network, writes only
+            // stall on an erase when the network never leaves such a gap....
+            if constexpr (std::is_same_v<T_Writer, PartitionWriter>) {
+                if (writer.eraseAhead()) {
+                    continue;
+                }
+            }
+
+            delay(1);
+            continue;
+        }
+
+        size_t chunkSize = std::min({available, remaining, DOWNLOAD_BUFFER_SIZE});
+        if (!_rateLimiter.acquire(chunkSize, _cancellationToken)) {
+            writer.abort();
+            return UpdateError::CANCELLED;
+        }
+
+        size_t received = stream->readBytes(buffer.get(), chunkSize);
+        if (_signatureVerifier != nullptr) {
+            _signatureVerifier->update(buffer.get(), received);
+        }
+
+        if (writer.write(buffer.get(), received) != received) {
+            int updateError = _writerError(writer);
+            writer.abort();
+            return updateError;
+        }
+
+        size_t reportedSectors = _downloadedBytes / PROGRESS_INTERVAL;
+        remaining -= received;
+        _downloadedBytes += received;
+        lastReceivedAt = millis();
+        if (remaining == 0 || _downloadedBytes / PROGRESS_INTERVAL != reportedSectors) {
+            onProgress(size - remaining, size);
+        }
+    }
+
+    // the image was hashed on the way in, so no second pass over the flash....
+    if (_signatureVerifier != nullptr && !_signatureVerifier->verify(signature)) {
+        writer.abort();
+        return UpdateError::SIGNATURE_INVALID;
+    }
+
+    if (!writer.end()) {
+        return _writerError(writer);
+    }
+
+    onEnd();
+    return 0;
+}
+
+template <typename T_ResponseData, typename T_PayloadModel, typename T_Parser>
+template <typename T_Writer>
+int Voyager::OTA<T_ResponseData, T_PayloadModel, T_Parser>::_writerError(T_Writer& writer) {
+    // a writer can turn data down without recording why, 0 would be taken
+    // for success and reboot into an image that was never finished....
+    int error = writer.getError();
+    if (error != 0) {
+        return error;
+    }
+    return std::is_same_v<T_Writer, PartitionWriter> ? PartitionError::WRITE_FAILED : UPDATE_ERROR_WRITE;
 }
 #endif
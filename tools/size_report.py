@@ -0,0 +1,293 @@
+#!/usr/bin/env python3
+"""Flash and static RAM footprint of the example configurations.
+
+Builds every example with arduino-cli, together with an empty sketch used as
+the framework baseline, and prints a JSON report with the section sizes, the
+cost of each module (grouped by namespace) and the largest symbols.
+
+    python3 tools/size_report.py > size.json
+    python3 tools/size_report.py --compare size.json
+
+Requires arduino-cli with the esp32 core and the library dependencies
+installed. The chip and its architecture (Xtensa or RISC-V) are read from the
+board properties of --fqbn, they pick the toolchain and the section names.
+The toolchain's size and nm are looked up in the core's tools directory unless
+--toolchain-prefix is given.
+
+With --host-build pointing at a build of extras/tests, every configuration
+also gets a "host" entry: the sizes of its host equivalent (HostFootprint*)
+and the heap use of a simulated check-and-update run. --host-only reports
+just that, without arduino-cli.
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+REPO_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+EXAMPLES = ["VoyagerOTA", "GithubOTA", "CustomOTA"]
+
+EMPTY_SKETCH = "void setup() {}\nvoid loop() {}\n"
+
+# Per build.tarch of the board: toolchain prefixes to look for ({mcu} is
+# build.mcu, newer toolchains dropped the chip from the name), the sections
+# loaded into RAM at boot (copied from flash or zeroed) and everything stored
+# in the image, RAM initializers included. .flash.rodata_noload is NOLOAD, it
+# only reserves address space and takes no room in the image. The RISC-V
+# chips have no separate vector section, but keep initialized data in IRAM.
+ARCHITECTURES = {
+    "xtensa": {
+        "toolchains": ("xtensa-{mcu}-elf-", "xtensa-esp-elf-"),
+        "static_ram": (".dram0.data", ".dram0.bss", ".noinit"),
+        "flash": (".iram0.vectors", ".iram0.text", ".dram0.data", ".flash.text", ".flash.rodata", ".flash.appdesc"),
+    },
+    "riscv32": {
+        "toolchains": ("riscv32-esp-elf-",),
+        "static_ram": (".iram0.data", ".dram0.data", ".dram0.bss", ".noinit"),
+        "flash": (".iram0.text", ".iram0.data", ".dram0.data", ".flash.text", ".flash.rodata", ".flash.appdesc"),
+    },
+}
+
+# The same split for the host equivalents, an x86-64 or arm64 ELF.
+HOST_CODE_SECTIONS = (".text", ".rodata", ".data.rel.ro", ".data")
+HOST_STATIC_RAM_SECTIONS = (".data", ".bss")
+
+HOST_HEAP_KEYS = ("peak_heap", "allocations", "allocated_bytes", "leaked_bytes")
+
+
+def run(command, **kwargs):
+    return subprocess.run(command, check=True, capture_output=True, text=True, **kwargs).stdout
+
+
+def library_version():
+    with open(os.path.join(REPO_DIR, "library.properties")) as properties:
+        for line in properties:
+            if line.startswith("version="):
+                return line.split("=", 1)[1].strip()
+    return None
+
+
+def git_revision():
+    try:
+        return run(["git", "-C", REPO_DIR, "rev-parse", "--short", "HEAD"]).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def board_target(fqbn):
+    """Returns (mcu, architecture) of the board, e.g. ("esp32c3", "riscv32")."""
+    try:
+        output = run(["arduino-cli", "board", "details", "--fqbn", fqbn, "--show-properties"])
+    except (OSError, subprocess.CalledProcessError) as error:
+        sys.exit("size_report: no board properties for %s (%s)" % (fqbn, error))
+
+    properties = dict(line.split("=", 1) for line in output.splitlines() if "=" in line)
+    mcu = properties.get("build.mcu")
+    architecture = properties.get("build.tarch")
+    if not mcu or architecture not in ARCHITECTURES:
+        sys.exit("size_report: %s targets architecture %s, only %s are supported" % (fqbn, architecture or "(unknown)", " and ".join(sorted(ARCHITECTURES))))
+    return mcu, architecture
+
+
+def find_tool(prefix, name, mcu, architecture):
+    if prefix:
+        return prefix + name
+
+    # arduino-cli keeps the toolchains under its data directory....
+    config = json.loads(run(["arduino-cli", "config", "dump", "--format", "json"]))
+    data_dir = config.get("config", config).get("directories", {}).get("data")
+    data_dir = data_dir or os.path.expanduser("~/.arduino15")
+    toolchains = [toolchain.format(mcu=mcu) for toolchain in ARCHITECTURES[architecture]["toolchains"]]
+    for toolchain in toolchains:
+        matches = sorted(glob.glob(os.path.join(data_dir, "packages", "esp32", "tools", "*", "*", "bin", toolchain + name)))
+        if matches:
+            return matches[-1]
+    sys.exit("size_report: %s not found, pass --toolchain-prefix" % " or ".join(toolchain + name for toolchain in toolchains))
+
+
+def compile_sketch(sketch_dir, fqbn, build_dir):
+    command = ["arduino-cli", "compile", "--fqbn", fqbn, "--library", REPO_DIR, "--build-path", build_dir, sketch_dir]
+    try:
+        run(command)
+    except subprocess.CalledProcessError as error:
+        sys.stderr.write(error.stdout + error.stderr)
+        sys.exit("size_report: %s failed to compile" % os.path.basename(sketch_dir))
+
+    elf = glob.glob(os.path.join(build_dir, "*.elf"))
+    if not elf:
+        sys.exit("size_report: no elf produced for %s" % os.path.basename(sketch_dir))
+    return elf[0]
+
+
+def read_sections(size_tool, elf):
+    sections = {}
+    for line in run([size_tool, "-A", elf]).splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0].startswith(".") and fields[1].isdigit():
+            sections[fields[0]] = int(fields[1])
+    return sections
+
+
+def module_of(symbol):
+    # Voyager::OTA<...>::performUpdate() -> Voyager::OTA, semver::version::parse -> semver,
+    # the return type nm prints for template functions is dropped....
+    name = re.sub(r"<.*", "", symbol.split("(", 1)[0])
+    name = name.split()[-1] if name.strip() else name
+    parts = [part for part in name.split("::") if part]
+    if len(parts) < 2:
+        return "(global)"
+    if parts[0] == "Voyager":
+        return "::".join(parts[:2])
+    return parts[0]
+
+
+def read_symbols(nm_tool, elf):
+    symbols = []
+    for line in run([nm_tool, "--size-sort", "--print-size", "--demangle", "--defined-only", elf]).splitlines():
+        fields = line.split(None, 3)
+        if len(fields) == 4:
+            symbols.append({"name": fields[3], "type": fields[2], "size": int(fields[1], 16)})
+    return symbols
+
+
+def summarize(sections, architecture):
+    return {
+        "flash": sum(sections.get(name, 0) for name in ARCHITECTURES[architecture]["flash"]),
+        "static_ram": sum(sections.get(name, 0) for name in ARCHITECTURES[architecture]["static_ram"]),
+    }
+
+
+def measure(name, sketch_dir, args, target, work_dir):
+    elf = compile_sketch(sketch_dir, args.fqbn, os.path.join(work_dir, "build-" + name))
+    sections = read_sections(target["size"], elf)
+    symbols = read_symbols(target["nm"], elf)
+
+    modules = {}
+    for symbol in symbols:
+        module = module_of(symbol["name"])
+        modules[module] = modules.get(module, 0) + symbol["size"]
+
+    report = {"name": name, "sketch": os.path.relpath(sketch_dir, REPO_DIR), "sections": sections}
+    report.update(summarize(sections, target["architecture"]))
+    report["modules"] = dict(sorted(modules.items(), key=lambda item: -item[1]))
+    report["symbols"] = sorted(symbols, key=lambda symbol: -symbol["size"])[: args.top]
+    return report
+
+
+def measure_host(name, host_build, args):
+    executable = os.path.join(host_build, "HostFootprint" + name)
+    if not os.path.exists(executable):
+        sys.exit("size_report: %s not found, build extras/tests first" % executable)
+
+    # the run prints its heap use as one JSON line....
+    try:
+        heap = json.loads(run([executable]))
+    except subprocess.CalledProcessError as error:
+        sys.stderr.write(error.stdout + error.stderr)
+        sys.exit("size_report: the simulated update of %s failed" % name)
+
+    sections = read_sections("size", executable)
+    symbols = read_symbols("nm", executable)
+    modules = {}
+    for symbol in symbols:
+        module = module_of(symbol["name"])
+        modules[module] = modules.get(module, 0) + symbol["size"]
+
+    report = {"executable": os.path.basename(executable), "sections": sections}
+    report["code"] = sum(sections.get(section, 0) for section in HOST_CODE_SECTIONS)
+    report["static_ram"] = sum(sections.get(section, 0) for section in HOST_STATIC_RAM_SECTIONS)
+    if not heap.get("updated"):
+        sys.exit("size_report: the simulated update of %s did not install the image" % name)
+    report.update({key: heap[key] for key in HOST_HEAP_KEYS})
+    report["modules"] = dict(sorted(modules.items(), key=lambda item: -item[1]))
+    report["symbols"] = sorted(symbols, key=lambda symbol: -symbol["size"])[: args.top]
+    return report
+
+
+def compare(reports, previous):
+    previous = {report["name"]: report for report in previous.get("configurations", [])}
+    for report in reports:
+        old = previous.get(report["name"])
+        if old is None:
+            continue
+        keys = [key for key in ("flash", "static_ram", "library_flash", "library_static_ram") if key in report]
+        change = {key: report[key] - old.get(key, 0) for key in keys}
+        if "host" in report and "host" in old:
+            change["host"] = {key: report["host"][key] - old["host"].get(key, 0) for key in ("code", "static_ram") + HOST_HEAP_KEYS}
+        report["change"] = change
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--fqbn", default="esp32:esp32:esp32")
+    parser.add_argument("--toolchain-prefix", help="e.g. /opt/esp/bin/xtensa-esp32-elf- or /opt/esp/bin/riscv32-esp-elf-")
+    parser.add_argument("--top", type=int, default=40, help="number of largest symbols listed per configuration")
+    parser.add_argument("--compare", metavar="REPORT", help="previous report, adds a change entry to each configuration")
+    parser.add_argument("--output", metavar="FILE", help="defaults to stdout")
+    parser.add_argument("--host-build", metavar="DIR", help="build directory of extras/tests, adds the host equivalents")
+    parser.add_argument("--host-only", action="store_true", help="skip the arduino-cli builds, needs --host-build")
+    parser.add_argument("examples", nargs="*", default=EXAMPLES)
+    args = parser.parse_args()
+    if args.host_only and not args.host_build:
+        parser.error("--host-only needs --host-build")
+
+    reports = [{"name": example} for example in args.examples]
+    baseline = None
+    target = None
+    if not args.host_only:
+        # checked before anything is compiled....
+        mcu, architecture = board_target(args.fqbn)
+        target = {
+            "mcu": mcu,
+            "architecture": architecture,
+            "size": find_tool(args.toolchain_prefix, "size", mcu, architecture),
+            "nm": find_tool(args.toolchain_prefix, "nm", mcu, architecture),
+        }
+
+        with tempfile.TemporaryDirectory(prefix="voyager-size-") as work_dir:
+            empty_dir = os.path.join(work_dir, "Empty")
+            os.makedirs(empty_dir)
+            with open(os.path.join(empty_dir, "Empty.ino"), "w") as sketch:
+                sketch.write(EMPTY_SKETCH)
+            baseline = measure("Empty", empty_dir, args, target, work_dir)
+
+            for report in reports:
+                report.update(measure(report["name"], os.path.join(REPO_DIR, "examples", report["name"]), args, target, work_dir))
+                # what the sketch adds on top of the bare framework....
+                report["library_flash"] = report["flash"] - baseline["flash"]
+                report["library_static_ram"] = report["static_ram"] - baseline["static_ram"]
+
+    if args.host_build:
+        for report in reports:
+            report["host"] = measure_host(report["name"], args.host_build, args)
+
+    result = {
+        "library": "Voyager-OTA-Client",
+        "version": library_version(),
+        "revision": git_revision(),
+        "fqbn": None if args.host_only else args.fqbn,
+        "mcu": None if target is None else target["mcu"],
+        "architecture": None if target is None else target["architecture"],
+        "baseline": None if baseline is None else {key: baseline[key] for key in ("sections", "flash", "static_ram")},
+        "configurations": reports,
+    }
+
+    if args.compare:
+        with open(args.compare) as previous:
+            compare(reports, json.load(previous))
+
+    output = json.dumps(result, indent=2) + "\n"
+    if args.output:
+        with open(args.output, "w") as report_file:
+            report_file.write(output)
+    else:
+        sys.stdout.write(output)
+
+
+if __name__ == "__main__":
+    main()